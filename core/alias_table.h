@@ -0,0 +1,80 @@
+//
+//  alias_table.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_ALIAS_TABLE_H_
+#define YCSB_C_ALIAS_TABLE_H_
+
+#include <cstdint>
+#include <vector>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Walker's alias method, built with Vose's algorithm: after an O(n) Build,
+/// each weighted choice takes one random integer, one multiply-shift to pick
+/// a column and one comparison to pick between the column and its alias.
+/// Sampling only reads the table, so threads may share it.
+///
+class AliasTable {
+ public:
+  ///
+  /// @param weights Non-negative weights, not all zero. They need not sum
+  ///        to one.
+  ///
+  void Build(const std::vector<double> &weights);
+
+  std::size_t size() const { return alias_.size(); }
+
+  /// Maps 64 uniformly random bits to an index in [0, size()).
+  std::size_t Sample(uint64_t random) const {
+    const uint64_t i = ((random >> 32) * size()) >> 32;
+    return (random & 0xffffffff) < threshold_[i] ? i : alias_[i];
+  }
+
+ private:
+  /// Column i keeps itself if the low 32 random bits fall below this.
+  std::vector<uint64_t> threshold_;
+  std::vector<uint32_t> alias_;
+};
+
+inline void AliasTable::Build(const std::vector<double> &weights) {
+  const std::size_t n = weights.size();
+  double sum = 0;
+  for (double w : weights) {
+    if (w < 0) throw utils::Exception("AliasTable: negative weight");
+    sum += w;
+  }
+  if (n == 0 || sum <= 0) throw utils::Exception("AliasTable: weights sum to zero");
+
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (std::size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * n / sum;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+
+  const double kOne = 4294967296.0; // 2^32
+  threshold_.assign(n, (uint64_t)kOne);
+  alias_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) alias_[i] = i;
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back();
+    small.pop_back();
+    uint32_t l = large.back();
+    threshold_[s] = (uint64_t)(scaled[s] * kOne);
+    alias_[s] = l;
+    scaled[l] += scaled[s] - 1;
+    if (scaled[l] < 1) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Whatever is left is full up to rounding error and keeps the default.
+}
+
+} // ycsbc
+
+#endif // YCSB_C_ALIAS_TABLE_H_
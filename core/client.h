@@ -18,10 +18,14 @@ namespace ycsbc {
 
 class Client {
  public:
-  Client(DB &db, CoreWorkload &wl) : db_(db), workload_(wl) { }
+  Client(DB &db, CoreWorkload &wl) :
+      db_(db), workload_(wl), last_op_(INSERT), expire_pending_(false),
+      key_pos_(kKeyBatch) { }
   
   virtual bool DoInsert();
   virtual bool DoTransaction();
+  /// The kind of the operation done last.
+  Operation last_operation() const { return last_op_; }
   
   virtual ~Client() { }
   
@@ -32,12 +36,46 @@ class Client {
   virtual int TransactionScan();
   virtual int TransactionUpdate();
   virtual int TransactionInsert();
+  virtual int TransactionDelete();
+
+  ///
+  /// Takes the next key from a buffer refilled kKeyBatch key numbers at a
+  /// time, instead of calling the key generator once per operation.
+  ///
+  std::string NextTransactionKey();
+  std::string NextReadKey(); ///< Also honors the readtarget property
   
   DB &db_;
   CoreWorkload &workload_;
+  Operation last_op_;
+  /// Under churn, whether an insert succeeded and the next transaction is
+  /// the delete that expires the oldest record.
+  bool expire_pending_;
+
+ private:
+  static const std::size_t kKeyBatch = 256;
+  uint64_t key_nums_[kKeyBatch];
+  std::size_t key_pos_;
 };
 
+inline std::string Client::NextTransactionKey() {
+  if (key_pos_ == kKeyBatch) {
+    workload_.NextTransactionKeyNums(key_nums_, kKeyBatch);
+    key_pos_ = 0;
+  }
+  return workload_.TransactionKeyName(key_nums_[key_pos_++]);
+}
+
+inline std::string Client::NextReadKey() {
+  if (key_pos_ == kKeyBatch) {
+    workload_.NextTransactionKeyNums(key_nums_, kKeyBatch);
+    key_pos_ = 0;
+  }
+  return workload_.ReadKeyName(key_nums_[key_pos_++]);
+}
+
 inline bool Client::DoInsert() {
+  last_op_ = INSERT;
   std::string key = workload_.NextSequenceKey();
   std::vector<DB::KVPair> pairs;
   workload_.BuildValues(pairs);
@@ -46,7 +84,10 @@ inline bool Client::DoInsert() {
 
 inline bool Client::DoTransaction() {
   int status = -1;
-  switch (workload_.NextOperation()) {
+  // Keeps the table of the insert, as NextOperation is not called.
+  last_op_ = expire_pending_ ? DELETE : workload_.NextOperation();
+  expire_pending_ = false;
+  switch (last_op_) {
     case READ:
       status = TransactionRead();
       break;
@@ -62,6 +103,9 @@ inline bool Client::DoTransaction() {
     case READMODIFYWRITE:
       status = TransactionReadModifyWrite();
       break;
+    case DELETE:
+      status = TransactionDelete();
+      break;
     default:
       throw utils::Exception("Operation request is not recognized!");
   }
@@ -71,7 +115,7 @@ inline bool Client::DoTransaction() {
 
 inline int Client::TransactionRead() {
   const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
+  const std::string &key = NextReadKey();
   std::vector<DB::KVPair> result;
   if (!workload_.read_all_fields()) {
     std::vector<std::string> fields;
@@ -84,7 +128,7 @@ inline int Client::TransactionRead() {
 
 inline int Client::TransactionReadModifyWrite() {
   const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
+  const std::string &key = NextTransactionKey();
   std::vector<DB::KVPair> result;
 
   if (!workload_.read_all_fields()) {
@@ -106,7 +150,7 @@ inline int Client::TransactionReadModifyWrite() {
 
 inline int Client::TransactionScan() {
   const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
+  const std::string &key = NextTransactionKey();
   int len = workload_.NextScanLength();
   std::vector<std::vector<DB::KVPair>> result;
   if (!workload_.read_all_fields()) {
@@ -120,7 +164,7 @@ inline int Client::TransactionScan() {
 
 inline int Client::TransactionUpdate() {
   const std::string &table = workload_.NextTable();
-  const std::string &key = workload_.NextTransactionKey();
+  const std::string &key = NextTransactionKey();
   std::vector<DB::KVPair> values;
   if (workload_.write_all_fields()) {
     workload_.BuildValues(values);
@@ -135,8 +179,16 @@ inline int Client::TransactionInsert() {
   const std::string &key = workload_.NextSequenceKey();
   std::vector<DB::KVPair> values;
   workload_.BuildValues(values);
-  return db_.Insert(table, key, values);
-} 
+  int status = db_.Insert(table, key, values);
+  // Expires the oldest record next, to keep the live count steady.
+  expire_pending_ = status == DB::kOK && workload_.churn();
+  return status;
+}
+
+inline int Client::TransactionDelete() {
+  const std::string &table = workload_.NextTable();
+  return db_.Delete(table, workload_.NextDeleteKey());
+}
 
 } // ycsbc
 
@@ -0,0 +1,463 @@
+//
+//  coordinator.cc
+//  YCSB-C
+//
+
+#include "coordinator.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using ycsbc::Connection;
+using ycsbc::Coordinator;
+using ycsbc::CoordinatorLink;
+using std::string;
+using std::cerr;
+using std::endl;
+
+const string Coordinator::WORKERS_PROPERTY = "coordinator.workers";
+
+const string Coordinator::PORT_PROPERTY = "coordinator.port";
+const string Coordinator::PORT_DEFAULT = "7070";
+
+const string Coordinator::ADDRESS_PROPERTY = "coordinator.address";
+
+const string Coordinator::SPAWN_PROPERTY = "coordinator.spawn";
+const string Coordinator::SPAWN_DEFAULT = "false";
+
+const string Coordinator::INTERVAL_PROPERTY = "coordinator.interval";
+const string Coordinator::INTERVAL_DEFAULT = "1";
+
+namespace {
+
+const double kKilo = 1000;
+
+string SystemError(const string &what) {
+  return what + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+Connection::~Connection() {
+  close(fd_);
+}
+
+void Connection::Send(const string &line) {
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  const string message = line + '\n';
+  std::size_t sent = 0;
+  while (sent < message.size()) {
+    const ssize_t n = send(fd_, message.data() + sent, message.size() - sent,
+                           MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) throw utils::Exception(SystemError("Cannot send to peer"));
+    sent += n;
+  }
+}
+
+bool Connection::TakeLine(string &line) {
+  const std::size_t end = buffer_.find('\n');
+  if (end == string::npos) return false;
+  line.assign(buffer_, 0, end);
+  buffer_.erase(0, end + 1);
+  return true;
+}
+
+bool Connection::Receive(string &line) {
+  char chunk[4096];
+  while (!TakeLine(line)) {
+    const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    buffer_.append(chunk, n);
+  }
+  return true;
+}
+
+bool Connection::ReceiveAvailable(std::vector<string> &lines) {
+  char chunk[4096];
+  const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+  if (n < 0 && errno == EINTR) return true;
+  if (n <= 0) return false;
+  buffer_.append(chunk, n);
+  string line;
+  while (TakeLine(line)) lines.push_back(line);
+  return true;
+}
+
+Coordinator::Coordinator(const utils::Properties &p, const string &label) :
+    props_(p), label_(label),
+    num_workers_(std::stoi(p.GetProperty(WORKERS_PROPERTY))),
+    port_(std::stoi(p.GetProperty(PORT_PROPERTY, PORT_DEFAULT))),
+    interval_(std::stod(p.GetProperty(INTERVAL_PROPERTY, INTERVAL_DEFAULT))),
+    num_live_(0), num_threads_(0), failed_(false), num_ready_(0),
+    num_loaded_(0), loaded_records_(0), load_seconds_(0), phase_(-1),
+    progress_seconds_(0), progress_ops_(0), run_ops_(0), run_seconds_(0) {
+  if (interval_ <= 0) {
+    throw utils::Exception("coordinator.interval must be positive");
+  }
+}
+
+int Coordinator::Run(int argc, const char *argv[]) {
+  const int listen_fd = Listen();
+  if (utils::StrToBool(props_.GetProperty(SPAWN_PROPERTY, SPAWN_DEFAULT))) {
+    Spawn(argc, argv);
+  }
+  Accept(listen_fd);
+  close(listen_fd);
+
+  typedef std::chrono::steady_clock Clock;
+  const Clock::duration interval = std::chrono::duration_cast<
+      Clock::duration>(std::chrono::duration<double>(interval_));
+  Clock::time_point next_progress = Clock::now() + interval;
+  std::vector<pollfd> fds;
+  std::vector<std::size_t> polled;
+  while (num_live_ > 0) {
+    fds.clear();
+    polled.clear();
+    for (std::size_t i = 0; i < workers_.size(); ++i) {
+      if (!workers_[i]) continue;
+      fds.push_back({workers_[i]->fd(), POLLIN, 0});
+      polled.push_back(i);
+    }
+    const int timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        next_progress - Clock::now()).count();
+    if (poll(fds.data(), fds.size(), std::max(timeout, 0)) < 0 &&
+        errno != EINTR) {
+      throw utils::Exception(SystemError("Cannot poll workers"));
+    }
+    for (std::size_t k = 0; k < fds.size(); ++k) {
+      if (!fds[k].revents) continue;
+      const std::size_t i = polled[k];
+      std::vector<string> lines;
+      const bool open = workers_[i]->ReceiveAvailable(lines);
+      for (const string &line : lines) Handle(i, line);
+      if (!open) Disconnect(i);
+    }
+    if (Clock::now() >= next_progress) {
+      PrintProgress();
+      next_progress = Clock::now() + interval;
+    }
+  }
+
+  cerr << "# Transaction throughput (KTPS)" << endl;
+  cerr << props_["dbname"] << '\t' << label_ << '\t' << num_threads_ << '\t';
+  cerr << (run_seconds_ > 0 ? run_ops_ / run_seconds_ / kKilo : 0) << endl;
+  if (!Reap(true)) failed_ = true;
+  return failed_ ? 1 : 0;
+}
+
+int Coordinator::Listen() {
+  const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) throw utils::Exception(SystemError("Cannot create socket"));
+  const int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port_);
+  if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, num_workers_) < 0) {
+    throw utils::Exception(SystemError("Cannot listen on port " +
+                                       std::to_string(port_)));
+  }
+  // Learns the port the system picked for port 0.
+  socklen_t len = sizeof(addr);
+  getsockname(fd, (sockaddr *)&addr, &len);
+  port_ = ntohs(addr.sin_port);
+  cerr << "# Coordinator:\tport " << port_ << "\t" << num_workers_;
+  cerr << " workers" << endl;
+  return fd;
+}
+
+void Coordinator::Spawn(int argc, const char *argv[]) {
+  // Later -p options override earlier ones, so the workers keep every other
+  // property of this command line.
+  std::vector<string> args(argv, argv + argc);
+  args.push_back("-p");
+  args.push_back(WORKERS_PROPERTY + "=0");
+  args.push_back("-p");
+  args.push_back(ADDRESS_PROPERTY + "=127.0.0.1:" + std::to_string(port_));
+  std::vector<char *> child_argv;
+  for (string &arg : args) child_argv.push_back(&arg[0]);
+  child_argv.push_back(NULL);
+
+  for (int i = 0; i < num_workers_; ++i) {
+    const pid_t pid = fork();
+    if (pid < 0) throw utils::Exception(SystemError("Cannot start worker"));
+    if (pid == 0) {
+      execvp(child_argv[0], child_argv.data());
+      cerr << SystemError("Cannot run " + args[0]) << endl;
+      _exit(127);
+    }
+    children_.push_back(pid);
+  }
+}
+
+void Coordinator::Accept(int listen_fd) {
+  while ((int)workers_.size() < num_workers_) {
+    pollfd pfd = {listen_fd, POLLIN, 0};
+    const int ready = poll(&pfd, 1, 1000);
+    if (ready < 0 && errno != EINTR) {
+      throw utils::Exception(SystemError("Cannot poll for workers"));
+    }
+    if (ready <= 0) {
+      if (!Reap(false)) {
+        throw utils::Exception("A worker exited before connecting");
+      }
+      continue;
+    }
+    const int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      throw utils::Exception(SystemError("Cannot accept worker"));
+    }
+    const int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    Connection *worker = new Connection(fd);
+    string hello, command;
+    int threads = 0;
+    if (!worker->Receive(hello) ||
+        !(std::istringstream(hello) >> command >> threads) ||
+        command != "HELLO") {
+      cerr << "# Coordinator:\tignored a connection that did not greet"
+           << endl;
+      delete worker;
+      continue;
+    }
+    worker->Send("WORKER " + std::to_string(workers_.size()) + " " +
+                 std::to_string(num_workers_));
+    workers_.push_back(worker);
+    num_threads_ += threads;
+  }
+  num_live_ = num_workers_;
+  snapshots_.resize(num_workers_);
+}
+
+void Coordinator::Handle(std::size_t worker, const string &line) {
+  std::istringstream input(line);
+  string command;
+  input >> command;
+  if (command == "READY") {
+    if (++num_ready_ >= num_live_) {
+      num_ready_ = 0;
+      Broadcast("GO");
+    }
+  } else if (command == "LOADED") {
+    uint64_t records;
+    double seconds;
+    input >> records >> seconds;
+    loaded_records_ += records;
+    load_seconds_ = std::max(load_seconds_, seconds);
+    if (++num_loaded_ == num_live_) {
+      cerr << "# Loading records:\t" << loaded_records_ << "\t";
+      cerr << load_seconds_ << " s" << endl;
+    }
+  } else if (command == "SNAPSHOT" || command == "DONE") {
+    int phase;
+    string name;
+    Snapshot snapshot;
+    input >> phase >> name >> snapshot.ops >> snapshot.oks >> snapshot.seconds;
+    if (!input) throw utils::Exception("Bad snapshot: " + line);
+    std::getline(input, snapshot.latency);
+    snapshot.done = command == "DONE";
+    if (phase != phase_) StartPhase(phase, name);
+    snapshots_[worker] = snapshot;
+    for (const Snapshot &s : snapshots_) {
+      if (!s.done) return;
+    }
+    PrintPhase();
+  } else {
+    throw utils::Exception("Unknown message from worker: " + line);
+  }
+}
+
+void Coordinator::Disconnect(std::size_t worker) {
+  delete workers_[worker];
+  workers_[worker] = NULL;
+  --num_live_;
+  if (phase_ >= 0 && !snapshots_[worker].done) {
+    // Counts what it got done, and lets the others finish without it.
+    cerr << "# Coordinator:\tworker " << worker << " left during phase ";
+    cerr << phase_ + 1 << endl;
+    failed_ = true;
+    snapshots_[worker].done = true;
+    bool all_done = true;
+    for (const Snapshot &s : snapshots_) all_done = all_done && s.done;
+    if (all_done) PrintPhase();
+  }
+  if (num_live_ > 0 && num_ready_ >= num_live_) {
+    num_ready_ = 0;
+    Broadcast("GO");
+  }
+}
+
+void Coordinator::StartPhase(int phase, const string &name) {
+  phase_ = phase;
+  phase_name_ = name;
+  progress_seconds_ = 0;
+  progress_ops_ = 0;
+  for (std::size_t i = 0; i < snapshots_.size(); ++i) {
+    snapshots_[i] = Snapshot();
+    snapshots_[i].done = !workers_[i]; // Gone workers have nothing to add
+  }
+}
+
+void Coordinator::PrintProgress() {
+  if (phase_ < 0) return;
+  uint64_t ops = 0;
+  double seconds = 0;
+  utils::Histogram latency;
+  // Finished workers keep their final counts in, so that the sum never
+  // drops while the others run on.
+  for (const Snapshot &s : snapshots_) {
+    if (s.latency.empty()) continue;
+    ops += s.ops;
+    seconds = std::max(seconds, s.seconds);
+    std::istringstream input(s.latency);
+    latency.Deserialize(input);
+  }
+  if (seconds <= progress_seconds_ || ops < progress_ops_) return;
+  cerr << "# Progress (" << phase_name_ << "):\t" << seconds << " s\t";
+  cerr << ops << " ops\t";
+  cerr << (ops - progress_ops_) / (seconds - progress_seconds_) / kKilo;
+  cerr << " KTPS\tp99 " << latency.Percentile(99) / kKilo << " us" << endl;
+  progress_seconds_ = seconds;
+  progress_ops_ = ops;
+}
+
+void Coordinator::PrintPhase() {
+  uint64_t ops = 0, oks = 0;
+  double seconds = 0;
+  utils::Histogram latency;
+  for (const Snapshot &s : snapshots_) {
+    ops += s.ops;
+    oks += s.oks;
+    seconds = std::max(seconds, s.seconds);
+    if (s.latency.empty()) continue;
+    std::istringstream input(s.latency);
+    latency.Deserialize(input);
+  }
+  run_ops_ += ops;
+  run_seconds_ += seconds;
+  run_latency_.Merge(latency);
+
+  cerr << "# Phase " << phase_ + 1 << " (" << phase_name_ << "):\t";
+  cerr << ops << " ops\t" << ops - oks << " failed\t" << seconds << " s\t";
+  cerr << (seconds > 0 ? ops / seconds / kKilo : 0) << " KTPS" << endl;
+  cerr << "# Latency (us):\tavg " << latency.Mean() / kKilo;
+  cerr << "\tp50 " << latency.Percentile(50) / kKilo;
+  cerr << "\tp95 " << latency.Percentile(95) / kKilo;
+  cerr << "\tp99 " << latency.Percentile(99) / kKilo;
+  cerr << "\tp99.9 " << latency.Percentile(99.9) / kKilo;
+  cerr << "\tmax " << latency.max() / kKilo << endl;
+  phase_ = -1;
+}
+
+void Coordinator::Broadcast(const string &line) {
+  for (Connection *worker : workers_) {
+    if (worker) worker->Send(line);
+  }
+}
+
+bool Coordinator::Reap(bool wait) {
+  bool ok = true;
+  for (std::size_t i = 0; i < children_.size(); ) {
+    int status;
+    const pid_t pid = waitpid(children_[i], &status, wait ? 0 : WNOHANG);
+    if (pid == 0) {
+      ++i;
+      continue;
+    }
+    if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    children_.erase(children_.begin() + i);
+  }
+  return ok;
+}
+
+CoordinatorLink::CoordinatorLink(const string &address, int num_threads) {
+  const std::size_t colon = address.rfind(':');
+  if (colon == string::npos) {
+    throw utils::Exception("coordinator.address needs host:port: " + address);
+  }
+  const string host = address.substr(0, colon);
+  const string port = address.substr(colon + 1);
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *addrs;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs) != 0) {
+    throw utils::Exception("Cannot resolve coordinator " + address);
+  }
+
+  // Retries for a while, as workers may start before the coordinator.
+  int fd = -1;
+  for (int attempt = 0; fd < 0 && attempt < 100; ++attempt) {
+    if (attempt) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (addrinfo *a = addrs; a && fd < 0; a = a->ai_next) {
+      fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) < 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+  }
+  freeaddrinfo(addrs);
+  if (fd < 0) {
+    throw utils::Exception(SystemError("Cannot connect to coordinator " +
+                                       address));
+  }
+  const int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  connection_ = new Connection(fd);
+
+  connection_->Send("HELLO " + std::to_string(num_threads));
+  string reply, command;
+  if (!connection_->Receive(reply) ||
+      !(std::istringstream(reply) >> command >> index_ >> count_) ||
+      command != "WORKER") {
+    throw utils::Exception("Coordinator did not number this worker");
+  }
+}
+
+void CoordinatorLink::Barrier() {
+  connection_->Send("READY");
+  string line;
+  while (connection_->Receive(line)) {
+    if (line == "GO") return;
+  }
+  throw utils::Exception("Coordinator closed the connection");
+}
+
+void CoordinatorLink::Loaded(uint64_t records, double seconds) {
+  connection_->Send("LOADED " + std::to_string(records) + " " +
+                    std::to_string(seconds));
+}
+
+void CoordinatorLink::Snapshot(int phase, const string &name, uint64_t ops,
+                               uint64_t oks, double seconds,
+                               const utils::Histogram &latency, bool done) {
+  // Keeps the name one word of the message.
+  string word = name.empty() ? "-" : name;
+  std::replace_if(word.begin(), word.end(), ::isspace, '_');
+  std::ostringstream message;
+  message << (done ? "DONE " : "SNAPSHOT ") << phase << ' ' << word << ' '
+          << ops << ' ' << oks << ' ' << seconds << ' ' << latency.Serialize();
+  connection_->Send(message.str());
+}
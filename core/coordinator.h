@@ -0,0 +1,182 @@
+//
+//  coordinator.h
+//  YCSB-C
+//
+//  Drives ycsbc worker processes through one run and merges their results.
+//
+
+#ifndef YCSB_C_COORDINATOR_H_
+#define YCSB_C_COORDINATOR_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "histogram.h"
+#include "properties.h"
+
+namespace ycsbc {
+
+///
+/// Newline-terminated text messages over a TCP connection.
+///
+class Connection {
+ public:
+  explicit Connection(int fd) : fd_(fd) { }
+  Connection(const Connection &) = delete;
+  Connection &operator=(const Connection &) = delete;
+  ~Connection();
+
+  int fd() const { return fd_; }
+  void Send(const std::string &line);
+  ///
+  /// Blocks until a whole line arrives. Returns false once the peer has
+  /// closed the connection.
+  ///
+  bool Receive(std::string &line);
+  ///
+  /// Reads what is available without blocking past one recv(), and moves
+  /// whole lines to lines. Returns false once the peer has closed.
+  ///
+  bool ReceiveAvailable(std::vector<std::string> &lines);
+
+ private:
+  bool TakeLine(std::string &line);
+
+  int fd_;
+  std::string buffer_;
+  std::mutex send_mutex_;
+};
+
+///
+/// The coordinator waits for coordinator.workers processes to connect,
+/// numbers them, and has them pass a barrier before loading and before each
+/// phase. Workers stream cumulative counts and latency histograms every
+/// coordinator.interval seconds, which the coordinator prints merged as
+/// progress, and then a final snapshot per phase for the merged report.
+///
+/// Each worker loads, inserts and transacts on the key numbers congruent to
+/// its index modulo the number of workers, and runs its share of
+/// operationcount and target.
+///
+class Coordinator {
+ public:
+  ///
+  /// The name of the property for the number of workers to coordinate.
+  /// A positive value makes the process a coordinator.
+  ///
+  static const std::string WORKERS_PROPERTY;
+
+  ///
+  /// The name of the property for the port the coordinator listens on.
+  ///
+  static const std::string PORT_PROPERTY;
+  static const std::string PORT_DEFAULT;
+
+  ///
+  /// The name of the property for the host:port of the coordinator, which
+  /// makes the process a worker.
+  ///
+  static const std::string ADDRESS_PROPERTY;
+
+  ///
+  /// The name of the property for whether the coordinator starts its
+  /// workers itself, as local processes with the same arguments.
+  ///
+  static const std::string SPAWN_PROPERTY;
+  static const std::string SPAWN_DEFAULT;
+
+  ///
+  /// The name of the property for the seconds between progress snapshots.
+  ///
+  static const std::string INTERVAL_PROPERTY;
+  static const std::string INTERVAL_DEFAULT;
+
+  Coordinator(const utils::Properties &p, const std::string &label);
+
+  ///
+  /// Runs the coordinator until every worker has disconnected.
+  ///
+  /// @param argc,argv The command line, to start local workers with.
+  /// @return The exit status for the process.
+  ///
+  int Run(int argc, const char *argv[]);
+
+ private:
+  /// The latest snapshot of a worker in the current phase.
+  struct Snapshot {
+    uint64_t ops = 0;
+    uint64_t oks = 0;
+    double seconds = 0;
+    std::string latency; ///< Serialized histogram
+    bool done = false;
+  };
+
+  int Listen();
+  void Spawn(int argc, const char *argv[]);
+  void Accept(int listen_fd);
+  void Handle(std::size_t worker, const std::string &line);
+  void Disconnect(std::size_t worker);
+  void StartPhase(int phase, const std::string &name);
+  void PrintProgress();
+  void PrintPhase();
+  void Broadcast(const std::string &line);
+  /// Reaps spawned workers that have exited. Returns false if any failed.
+  bool Reap(bool wait);
+
+  utils::Properties props_;
+  std::string label_;
+  int num_workers_;
+  int port_;
+  double interval_;
+
+  std::vector<Connection *> workers_; ///< NULL once disconnected
+  std::vector<int> children_;  ///< Pids of spawned workers
+  std::vector<Snapshot> snapshots_;
+  int num_live_;
+  int num_threads_;
+  bool failed_;
+  int num_ready_;
+  int num_loaded_;
+  uint64_t loaded_records_;
+  double load_seconds_;
+  int phase_;
+  std::string phase_name_;
+  double progress_seconds_;
+  uint64_t progress_ops_;
+  uint64_t run_ops_;
+  double run_seconds_;
+  utils::Histogram run_latency_;
+};
+
+///
+/// The worker end of the connection to a Coordinator. Snapshots may be
+/// sent from any thread.
+///
+class CoordinatorLink {
+ public:
+  ///
+  /// Connects to the coordinator and waits for this worker's number.
+  ///
+  CoordinatorLink(const std::string &address, int num_threads);
+  ~CoordinatorLink() { delete connection_; }
+
+  int index() const { return index_; }
+  int count() const { return count_; }
+
+  /// Returns once every worker has reached the barrier.
+  void Barrier();
+  void Loaded(uint64_t records, double seconds);
+  void Snapshot(int phase, const std::string &name, uint64_t ops,
+                uint64_t oks, double seconds, const utils::Histogram &latency,
+                bool done);
+
+ private:
+  Connection *connection_;
+  int index_;
+  int count_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_COORDINATOR_H_
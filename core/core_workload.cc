@@ -10,9 +10,15 @@
 #include "zipfian_generator.h"
 #include "scrambled_zipfian_generator.h"
 #include "skewed_latest_generator.h"
+#include "hotspot_generator.h"
+#include "sequential_generator.h"
+#include "exponential_generator.h"
 #include "const_generator.h"
 #include "core_workload.h"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <string>
 
 using ycsbc::CoreWorkload;
@@ -31,12 +37,23 @@ const string CoreWorkload::FIELD_LENGTH_DISTRIBUTION_DEFAULT = "constant";
 const string CoreWorkload::FIELD_LENGTH_PROPERTY = "fieldlength";
 const string CoreWorkload::FIELD_LENGTH_DEFAULT = "100";
 
+const string CoreWorkload::FIELD_LENGTH_HISTOGRAM_PROPERTY =
+    "fieldlengthhistogram";
+const string CoreWorkload::FIELD_LENGTH_HISTOGRAM_DEFAULT = "hist.txt";
+
+const string CoreWorkload::FIELD_COMPRESSION_RATIO_PROPERTY =
+    "fieldcompressionratio";
+const string CoreWorkload::FIELD_COMPRESSION_RATIO_DEFAULT = "1";
+
 const string CoreWorkload::READ_ALL_FIELDS_PROPERTY = "readallfields";
 const string CoreWorkload::READ_ALL_FIELDS_DEFAULT = "true";
 
 const string CoreWorkload::WRITE_ALL_FIELDS_PROPERTY = "writeallfields";
 const string CoreWorkload::WRITE_ALL_FIELDS_DEFAULT = "false";
 
+const string CoreWorkload::FIELD_WEIGHTS_PROPERTY = "fieldweights";
+const string CoreWorkload::FIELD_WEIGHTS_DEFAULT = "";
+
 const string CoreWorkload::READ_PROPORTION_PROPERTY = "readproportion";
 const string CoreWorkload::READ_PROPORTION_DEFAULT = "0.95";
 
@@ -53,13 +70,63 @@ const string CoreWorkload::READMODIFYWRITE_PROPORTION_PROPERTY =
     "readmodifywriteproportion";
 const string CoreWorkload::READMODIFYWRITE_PROPORTION_DEFAULT = "0.0";
 
+const string CoreWorkload::DELETE_PROPORTION_PROPERTY = "deleteproportion";
+const string CoreWorkload::DELETE_PROPORTION_DEFAULT = "0.0";
+
+const string CoreWorkload::READ_TARGET_PROPERTY = "readtarget";
+const string CoreWorkload::READ_TARGET_DEFAULT = "any";
+
+const string CoreWorkload::CHURN_PROPERTY = "churn";
+const string CoreWorkload::CHURN_DEFAULT = "false";
+
+const string CoreWorkload::CHURN_START_PROPERTY = "churnstart";
+const string CoreWorkload::CHURN_START_DEFAULT = "0";
+
 const string CoreWorkload::REQUEST_DISTRIBUTION_PROPERTY =
     "requestdistribution";
 const string CoreWorkload::REQUEST_DISTRIBUTION_DEFAULT = "uniform";
 
+const string CoreWorkload::ZIPFIAN_CONSTANT_PROPERTY = "zipfianconstant";
+const string CoreWorkload::ZIPFIAN_CONSTANT_DEFAULT = "0.99";
+
+const string CoreWorkload::HOTSPOT_ROTATION_SHIFT_PROPERTY =
+    "hotspotrotation.shift";
+const string CoreWorkload::HOTSPOT_ROTATION_SHIFT_DEFAULT = "0";
+
+const string CoreWorkload::HOTSPOT_ROTATION_OPS_PROPERTY =
+    "hotspotrotation.ops";
+const string CoreWorkload::HOTSPOT_ROTATION_OPS_DEFAULT = "0";
+
+const string CoreWorkload::HOTSPOT_ROTATION_SECONDS_PROPERTY =
+    "hotspotrotation.seconds";
+const string CoreWorkload::HOTSPOT_ROTATION_SECONDS_DEFAULT = "0";
+
+const string CoreWorkload::HOTSPOT_DATA_FRACTION_PROPERTY =
+    "hotspotdatafraction";
+const string CoreWorkload::HOTSPOT_DATA_FRACTION_DEFAULT = "0.2";
+
+const string CoreWorkload::HOTSPOT_OPN_FRACTION_PROPERTY = "hotspotopnfraction";
+const string CoreWorkload::HOTSPOT_OPN_FRACTION_DEFAULT = "0.8";
+
+const string CoreWorkload::EXPONENTIAL_PERCENTILE_PROPERTY =
+    "exponential.percentile";
+const string CoreWorkload::EXPONENTIAL_PERCENTILE_DEFAULT = "95";
+
+const string CoreWorkload::EXPONENTIAL_FRAC_PROPERTY = "exponential.frac";
+const string CoreWorkload::EXPONENTIAL_FRAC_DEFAULT = "0.8571428571";
+
 const string CoreWorkload::ZERO_PADDING_PROPERTY = "zeropadding";
 const string CoreWorkload::ZERO_PADDING_DEFAULT = "1";
 
+const string CoreWorkload::KEY_FORMAT_PROPERTY = "keyformat";
+const string CoreWorkload::KEY_FORMAT_DEFAULT = "decimal";
+
+const string CoreWorkload::KEY_PREFIX_PROPERTY = "keyprefix";
+const string CoreWorkload::KEY_PREFIX_DEFAULT = "user";
+
+const string CoreWorkload::KEY_LENGTH_PROPERTY = "keylength";
+const string CoreWorkload::KEY_LENGTH_DEFAULT = "0";
+
 const string CoreWorkload::MAX_SCAN_LENGTH_PROPERTY = "maxscanlength";
 const string CoreWorkload::MAX_SCAN_LENGTH_DEFAULT = "1000";
 
@@ -73,6 +140,11 @@ const string CoreWorkload::INSERT_ORDER_DEFAULT = "hashed";
 const string CoreWorkload::INSERT_START_PROPERTY = "insertstart";
 const string CoreWorkload::INSERT_START_DEFAULT = "0";
 
+const string CoreWorkload::KEY_PARTITION_INDEX_PROPERTY = "keypartition.index";
+const string CoreWorkload::KEY_PARTITION_INDEX_DEFAULT = "0";
+const string CoreWorkload::KEY_PARTITION_COUNT_PROPERTY = "keypartition.count";
+const string CoreWorkload::KEY_PARTITION_COUNT_DEFAULT = "1";
+
 const string CoreWorkload::RECORD_COUNT_PROPERTY = "recordcount";
 const string CoreWorkload::OPERATION_COUNT_PROPERTY = "operationcount";
 
@@ -81,7 +153,11 @@ void CoreWorkload::Init(const utils::Properties &p) {
   
   field_count_ = std::stoi(p.GetProperty(FIELD_COUNT_PROPERTY,
                                          FIELD_COUNT_DEFAULT));
-  field_len_generator_ = GetFieldLenGenerator(p);
+  uint64_t max_field_len;
+  field_len_generator_ = GetFieldLenGenerator(p, max_field_len);
+  value_generator_ = new ValueGenerator(std::stod(p.GetProperty(
+      FIELD_COMPRESSION_RATIO_PROPERTY, FIELD_COMPRESSION_RATIO_DEFAULT)),
+      max_field_len);
   
   double read_proportion = std::stod(p.GetProperty(READ_PROPORTION_PROPERTY,
                                                    READ_PROPORTION_DEFAULT));
@@ -93,11 +169,34 @@ void CoreWorkload::Init(const utils::Properties &p) {
                                                    SCAN_PROPORTION_DEFAULT));
   double readmodifywrite_proportion = std::stod(p.GetProperty(
       READMODIFYWRITE_PROPORTION_PROPERTY, READMODIFYWRITE_PROPORTION_DEFAULT));
+  double delete_proportion = std::stod(p.GetProperty(DELETE_PROPORTION_PROPERTY,
+                                                     DELETE_PROPORTION_DEFAULT));
   
   record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
                                            REQUEST_DISTRIBUTION_DEFAULT);
   zero_padding_ = std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY, ZERO_PADDING_DEFAULT));
+
+  key_prefix_ = p.GetProperty(KEY_PREFIX_PROPERTY, KEY_PREFIX_DEFAULT);
+  std::size_t key_len = std::stoul(p.GetProperty(KEY_LENGTH_PROPERTY,
+                                                 KEY_LENGTH_DEFAULT));
+  if (key_len && key_len <= key_prefix_.size()) {
+    throw utils::Exception("keylength leaves no room after the key prefix");
+  }
+  std::string key_format = p.GetProperty(KEY_FORMAT_PROPERTY,
+                                         KEY_FORMAT_DEFAULT);
+  if (key_format == "decimal") {
+    key_format_ = DECIMAL_KEY;
+    key_width_ = key_len ? key_len - key_prefix_.size() : zero_padding_;
+  } else if (key_format == "hex") {
+    key_format_ = HEX_KEY;
+    key_width_ = key_len ? key_len - key_prefix_.size() : 16;
+  } else if (key_format == "binary") {
+    key_format_ = BINARY_KEY;
+    key_width_ = key_len ? key_len - key_prefix_.size() : 8;
+  } else {
+    throw utils::Exception("Unknown key format: " + key_format);
+  }
   int max_scan_len = std::stoi(p.GetProperty(MAX_SCAN_LENGTH_PROPERTY,
                                              MAX_SCAN_LENGTH_DEFAULT));
   std::string scan_len_dist = p.GetProperty(SCAN_LENGTH_DISTRIBUTION_PROPERTY,
@@ -115,8 +214,37 @@ void CoreWorkload::Init(const utils::Properties &p) {
   } else {
     ordered_inserts_ = true;
   }
+  if (key_format_ != DECIMAL_KEY) {
+    // Hex and binary keys only keep the low digits that fit the width, so
+    // the width must hold the largest number: any 64-bit hash if hashed.
+    uint64_t max_key_num = ~uint64_t(0);
+    if (ordered_inserts_) {
+      max_key_num = insert_start + record_count_ + std::stoull(p.GetProperty(
+          OPERATION_COUNT_PROPERTY, "0"));
+    }
+    const int bits_per_digit = key_format_ == HEX_KEY ? 4 : 8;
+    std::size_t digits = 1;
+    while (digits * bits_per_digit < 64 &&
+           max_key_num >> digits * bits_per_digit) {
+      ++digits;
+    }
+    if (key_width_ < digits) {
+      const std::string unit = key_format_ == HEX_KEY ? " hex digits" : " bytes";
+      throw utils::Exception("keylength leaves " + std::to_string(key_width_) +
+          unit + " after the prefix, but the keys need " +
+          std::to_string(digits) + unit);
+    }
+  }
   
-  key_generator_ = new CounterGenerator(insert_start);
+  partition_index_ = std::stoul(p.GetProperty(KEY_PARTITION_INDEX_PROPERTY,
+                                              KEY_PARTITION_INDEX_DEFAULT));
+  partition_count_ = std::stoul(p.GetProperty(KEY_PARTITION_COUNT_PROPERTY,
+                                              KEY_PARTITION_COUNT_DEFAULT));
+  if (partition_count_ == 0 || partition_index_ >= partition_count_) {
+    throw utils::Exception("keypartition.index must be below keypartition.count");
+  }
+  key_generator_ = new CounterGenerator(insert_start + partition_index_,
+                                        partition_count_);
   
   if (read_proportion > 0) {
     op_chooser_.AddValue(READ, read_proportion);
@@ -133,8 +261,52 @@ void CoreWorkload::Init(const utils::Properties &p) {
   if (readmodifywrite_proportion > 0) {
     op_chooser_.AddValue(READMODIFYWRITE, readmodifywrite_proportion);
   }
+  if (delete_proportion > 0) {
+    op_chooser_.AddValue(DELETE, delete_proportion);
+  }
+  op_chooser_.Build();
+
+  std::string read_target = p.GetProperty(READ_TARGET_PROPERTY,
+                                          READ_TARGET_DEFAULT);
+  if (read_target == "any") {
+    read_target_ = ANY_KEY;
+  } else if (read_target == "live") {
+    read_target_ = LIVE_KEY;
+  } else if (read_target == "deleted") {
+    read_target_ = DELETED_KEY;
+  } else {
+    throw utils::Exception("Unknown read target: " + read_target);
+  }
+
+  churn_ = utils::StrToBool(p.GetProperty(CHURN_PROPERTY, CHURN_DEFAULT));
+  if (churn_ && partition_count_ > 1) {
+    throw utils::Exception("churn does not support key partitions");
+  }
+  churn_start_ = std::stoull(p.GetProperty(CHURN_START_PROPERTY,
+                                          CHURN_START_DEFAULT));
+  oldest_key_.store(churn_start_);
+  if (delete_proportion > 0 && !churn_) {
+    // Covers every key that loading and inserts can reach, which only a
+    // count of operations bounds.
+    const std::string op_count = p.GetProperty(OPERATION_COUNT_PROPERTY);
+    if (read_target_ != ANY_KEY && (op_count.empty() ||
+        std::stod(p.GetProperty("phase.duration", "0")) > 0)) {
+      throw utils::Exception("readtarget with deletes needs an operationcount "
+                             "and no phase.duration");
+    }
+    num_tracked_ = record_count_;
+    if (!op_count.empty()) num_tracked_ += std::stoull(op_count);
+    deleted_ = new std::atomic<uint64_t>[num_tracked_ / 64 + 1]();
+  }
   
   insert_key_sequence_.Set(record_count_);
+
+  double zipfian_const = std::stod(p.GetProperty(ZIPFIAN_CONSTANT_PROPERTY,
+                                                 ZIPFIAN_CONSTANT_DEFAULT));
+  if (zipfian_const <= 0 || zipfian_const == 1) {
+    throw utils::Exception("Invalid zipfian constant: " +
+                           p.GetProperty(ZIPFIAN_CONSTANT_PROPERTY));
+  }
   
   if (request_dist == "uniform") {
     key_chooser_ = new UniformGenerator(0, record_count_ - 1);
@@ -147,16 +319,64 @@ void CoreWorkload::Init(const utils::Properties &p) {
     // and pick another key.
     int op_count = std::stoi(p.GetProperty(OPERATION_COUNT_PROPERTY));
     int new_keys = (int)(op_count * insert_proportion * 2); // a fudge factor
-    key_chooser_ = new ScrambledZipfianGenerator(record_count_ + new_keys);
+    uint64_t num_keys = record_count_ + new_keys;
+    ScrambledZipfianGenerator *chooser = new ScrambledZipfianGenerator(
+        0, num_keys - 1, zipfian_const);
+    double shift = std::stod(p.GetProperty(HOTSPOT_ROTATION_SHIFT_PROPERTY,
+                                           HOTSPOT_ROTATION_SHIFT_DEFAULT));
+    chooser->SetRotation(shift * num_keys,
+        std::stoull(p.GetProperty(HOTSPOT_ROTATION_OPS_PROPERTY,
+                                  HOTSPOT_ROTATION_OPS_DEFAULT)),
+        std::stod(p.GetProperty(HOTSPOT_ROTATION_SECONDS_PROPERTY,
+                                HOTSPOT_ROTATION_SECONDS_DEFAULT)));
+    key_chooser_ = chooser;
     
   } else if (request_dist == "latest") {
-    key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_);
+    key_chooser_ = new SkewedLatestGenerator(insert_key_sequence_,
+                                             zipfian_const);
     
+  } else if (request_dist == "hotspot") {
+    double hot_set_fraction = std::stod(p.GetProperty(
+        HOTSPOT_DATA_FRACTION_PROPERTY, HOTSPOT_DATA_FRACTION_DEFAULT));
+    double hot_opn_fraction = std::stod(p.GetProperty(
+        HOTSPOT_OPN_FRACTION_PROPERTY, HOTSPOT_OPN_FRACTION_DEFAULT));
+    key_chooser_ = new HotspotGenerator(0, record_count_ - 1,
+                                        hot_set_fraction, hot_opn_fraction);
+
+  } else if (request_dist == "sequential") {
+    key_chooser_ = new SequentialGenerator(0, record_count_ - 1);
+
+  } else if (request_dist == "exponential") {
+    double percentile = std::stod(p.GetProperty(
+        EXPONENTIAL_PERCENTILE_PROPERTY, EXPONENTIAL_PERCENTILE_DEFAULT));
+    double frac = std::stod(p.GetProperty(EXPONENTIAL_FRAC_PROPERTY,
+                                          EXPONENTIAL_FRAC_DEFAULT));
+    key_chooser_ = new ExponentialGenerator(insert_key_sequence_, percentile,
+                                            record_count_ * frac);
+
   } else {
     throw utils::Exception("Unknown request distribution: " + request_dist);
   }
   
-  field_chooser_ = new UniformGenerator(0, field_count_ - 1);
+  std::string field_weights = p.GetProperty(FIELD_WEIGHTS_PROPERTY,
+                                           FIELD_WEIGHTS_DEFAULT);
+  if (field_weights.empty()) {
+    field_chooser_ = new UniformGenerator(0, field_count_ - 1);
+  } else {
+    DiscreteGenerator<uint64_t> *chooser = new DiscreteGenerator<uint64_t>;
+    field_chooser_ = chooser;
+    std::stringstream ss(field_weights);
+    std::string weight;
+    int i = 0;
+    for (; std::getline(ss, weight, ','); ++i) {
+      chooser->AddValue(i, std::stod(weight));
+    }
+    if (i != field_count_) {
+      throw utils::Exception("Expected " + std::to_string(field_count_) +
+          " field weights but got: " + field_weights);
+    }
+    chooser->Build();
+  }
   
   if (scan_len_dist == "uniform") {
     scan_len_chooser_ = new UniformGenerator(1, max_scan_len);
@@ -169,17 +389,45 @@ void CoreWorkload::Init(const utils::Properties &p) {
 }
 
 ycsbc::Generator<uint64_t> *CoreWorkload::GetFieldLenGenerator(
-    const utils::Properties &p) {
+    const utils::Properties &p, uint64_t &max_len) {
   string field_len_dist = p.GetProperty(FIELD_LENGTH_DISTRIBUTION_PROPERTY,
                                         FIELD_LENGTH_DISTRIBUTION_DEFAULT);
   int field_len = std::stoi(p.GetProperty(FIELD_LENGTH_PROPERTY,
                                           FIELD_LENGTH_DEFAULT));
+  max_len = field_len;
   if(field_len_dist == "constant") {
     return new ConstGenerator(field_len);
   } else if(field_len_dist == "uniform") {
     return new UniformGenerator(1, field_len);
   } else if(field_len_dist == "zipfian") {
     return new ZipfianGenerator(1, field_len);
+  } else if(field_len_dist == "histogram") {
+    string file = p.GetProperty(FIELD_LENGTH_HISTOGRAM_PROPERTY,
+                                FIELD_LENGTH_HISTOGRAM_DEFAULT);
+    std::ifstream input(file);
+    if (!input.is_open()) throw utils::Exception("Cannot open " + file);
+    DiscreteGenerator<uint64_t> *generator = new DiscreteGenerator<uint64_t>;
+    std::vector<std::pair<uint64_t, double>> buckets;
+    string line;
+    while (std::getline(input, line)) {
+      line = utils::Trim(line);
+      if (line.empty() || line[0] == '#') continue;
+      std::stringstream ss(line);
+      uint64_t len;
+      double weight;
+      if (!(ss >> len >> weight)) {
+        throw utils::Exception("Bad histogram line: " + line);
+      }
+      buckets.push_back(std::make_pair(len, weight));
+    }
+    if (buckets.empty()) throw utils::Exception("Empty histogram: " + file);
+    max_len = 0;
+    for (const auto &bucket : buckets) {
+      generator->AddValue(bucket.first, bucket.second);
+      max_len = std::max(max_len, bucket.first);
+    }
+    generator->Build();
+    return generator;
   } else {
     throw utils::Exception("Unknown field length distribution: " +
         field_len_dist);
@@ -190,7 +438,7 @@ void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
   for (int i = 0; i < field_count_; ++i) {
     ycsbc::DB::KVPair pair;
     pair.first.append("field").append(std::to_string(i));
-    pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
+    pair.second.assign(NextValue(field_len_generator_->Next()));
     values.push_back(pair);
   }
 }
@@ -198,7 +446,7 @@ void CoreWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
 void CoreWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
   ycsbc::DB::KVPair pair;
   pair.first.append(NextFieldName());
-  pair.second.append(field_len_generator_->Next(), utils::RandomPrintChar());
+  pair.second.assign(NextValue(field_len_generator_->Next()));
   update.push_back(pair);
 }
 
@@ -9,6 +9,7 @@
 #ifndef YCSB_C_CORE_WORKLOAD_H_
 #define YCSB_C_CORE_WORKLOAD_H_
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include "db.h"
@@ -16,6 +17,7 @@
 #include "generator.h"
 #include "discrete_generator.h"
 #include "counter_generator.h"
+#include "value_generator.h"
 #include "utils.h"
 
 namespace ycsbc {
@@ -25,9 +27,12 @@ enum Operation {
   READ,
   UPDATE,
   SCAN,
-  READMODIFYWRITE
+  READMODIFYWRITE,
+  DELETE
 };
 
+const int kNumOperations = DELETE + 1;
+
 class CoreWorkload {
  public:
   /// 
@@ -44,7 +49,8 @@ class CoreWorkload {
   
   /// 
   /// The name of the property for the field length distribution.
-  /// Options are "uniform", "zipfian" (favoring short records), and "constant".
+  /// Options are "uniform", "zipfian" (favoring short records), "constant"
+  /// and "histogram".
   ///
   static const std::string FIELD_LENGTH_DISTRIBUTION_PROPERTY;
   static const std::string FIELD_LENGTH_DISTRIBUTION_DEFAULT;
@@ -54,6 +60,21 @@ class CoreWorkload {
   ///
   static const std::string FIELD_LENGTH_PROPERTY;
   static const std::string FIELD_LENGTH_DEFAULT;
+
+  ///
+  /// The name of the property for the file that the histogram field length
+  /// distribution reads. Each line holds a length in bytes and its relative
+  /// weight; lines starting with '#' are skipped.
+  ///
+  static const std::string FIELD_LENGTH_HISTOGRAM_PROPERTY;
+  static const std::string FIELD_LENGTH_HISTOGRAM_DEFAULT;
+
+  ///
+  /// The name of the property for how much field values compress, as the
+  /// ratio of their raw size to compressed size. 1 is incompressible.
+  ///
+  static const std::string FIELD_COMPRESSION_RATIO_PROPERTY;
+  static const std::string FIELD_COMPRESSION_RATIO_DEFAULT;
   
   /// 
   /// The name of the property for deciding whether to read one field (false)
@@ -68,6 +89,14 @@ class CoreWorkload {
   ///
   static const std::string WRITE_ALL_FIELDS_PROPERTY;
   static const std::string WRITE_ALL_FIELDS_DEFAULT;
+
+  ///
+  /// The name of the property for comma-separated relative weights with
+  /// which single fields are picked to read or write, one per field.
+  /// Empty for a uniform choice.
+  ///
+  static const std::string FIELD_WEIGHTS_PROPERTY;
+  static const std::string FIELD_WEIGHTS_DEFAULT;
   
   /// 
   /// The name of the property for the proportion of read transactions.
@@ -99,13 +128,103 @@ class CoreWorkload {
   ///
   static const std::string READMODIFYWRITE_PROPORTION_PROPERTY;
   static const std::string READMODIFYWRITE_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for the proportion of delete transactions.
+  ///
+  static const std::string DELETE_PROPORTION_PROPERTY;
+  static const std::string DELETE_PROPORTION_DEFAULT;
+
+  ///
+  /// The name of the property for which keys reads go to.
+  /// Options are "any", "live" (not deleted) and "deleted".
+  ///
+  static const std::string READ_TARGET_PROPERTY;
+  static const std::string READ_TARGET_DEFAULT;
+
+  ///
+  /// The name of the property for TTL-style churn: deletes remove the
+  /// oldest live record, every successful insert is followed by such a
+  /// delete as the client's next operation, and request keys are drawn
+  /// from the records still live, so the live record count stays at
+  /// recordcount.
+  ///
+  static const std::string CHURN_PROPERTY;
+  static const std::string CHURN_DEFAULT;
+
+  ///
+  /// The name of the property for the number of the oldest live key under
+  /// churn, below which keys count as deleted.
+  ///
+  static const std::string CHURN_START_PROPERTY;
+  static const std::string CHURN_START_DEFAULT;
   
   /// 
   /// The name of the property for the the distribution of request keys.
-  /// Options are "uniform", "zipfian" and "latest".
+  /// Options are "uniform", "zipfian", "latest", "hotspot", "sequential"
+  /// and "exponential".
   ///
   static const std::string REQUEST_DISTRIBUTION_PROPERTY;
   static const std::string REQUEST_DISTRIBUTION_DEFAULT;
+
+  ///
+  /// The name of the property for the zipfian constant (theta) of the
+  /// zipfian and latest distributions. Larger values are more skewed;
+  /// it must not be 1.
+  ///
+  static const std::string ZIPFIAN_CONSTANT_PROPERTY;
+  static const std::string ZIPFIAN_CONSTANT_DEFAULT;
+
+  ///
+  /// The name of the property for how far the hot set of the zipfian
+  /// distribution moves at each rotation, as a fraction of the key space.
+  /// Zero disables rotation.
+  ///
+  static const std::string HOTSPOT_ROTATION_SHIFT_PROPERTY;
+  static const std::string HOTSPOT_ROTATION_SHIFT_DEFAULT;
+
+  ///
+  /// The name of the property for the number of key draws between
+  /// rotations of the zipfian hot set.
+  ///
+  static const std::string HOTSPOT_ROTATION_OPS_PROPERTY;
+  static const std::string HOTSPOT_ROTATION_OPS_DEFAULT;
+
+  ///
+  /// The name of the property for the seconds between rotations of the
+  /// zipfian hot set. Takes precedence over hotspotrotation.ops if positive.
+  ///
+  static const std::string HOTSPOT_ROTATION_SECONDS_PROPERTY;
+  static const std::string HOTSPOT_ROTATION_SECONDS_DEFAULT;
+
+  ///
+  /// The name of the property for the fraction of records in the hot set
+  /// of the hotspot distribution.
+  ///
+  static const std::string HOTSPOT_DATA_FRACTION_PROPERTY;
+  static const std::string HOTSPOT_DATA_FRACTION_DEFAULT;
+
+  ///
+  /// The name of the property for the fraction of operations that go to
+  /// the hot set of the hotspot distribution.
+  ///
+  static const std::string HOTSPOT_OPN_FRACTION_PROPERTY;
+  static const std::string HOTSPOT_OPN_FRACTION_DEFAULT;
+
+  ///
+  /// The name of the property for the percentage of operations of the
+  /// exponential distribution that fall within the latest
+  /// exponential.frac of the records.
+  ///
+  static const std::string EXPONENTIAL_PERCENTILE_PROPERTY;
+  static const std::string EXPONENTIAL_PERCENTILE_DEFAULT;
+
+  ///
+  /// The name of the property for the fraction of records that receive
+  /// exponential.percentile of the operations.
+  ///
+  static const std::string EXPONENTIAL_FRAC_PROPERTY;
+  static const std::string EXPONENTIAL_FRAC_DEFAULT;
   
   ///
   /// The name of the property for adding zero padding to record numbers in order to match 
@@ -114,6 +233,32 @@ class CoreWorkload {
   static const std::string ZERO_PADDING_PROPERTY;
   static const std::string ZERO_PADDING_DEFAULT;
 
+  ///
+  /// The name of the property for how key numbers are spelled after the
+  /// prefix. Options are "decimal", "hex" (lowercase, fixed width) and
+  /// "binary" (big-endian bytes, fixed width). All of them sort in numeric
+  /// order when the numbers fit the width.
+  ///
+  static const std::string KEY_FORMAT_PROPERTY;
+  static const std::string KEY_FORMAT_DEFAULT;
+
+  ///
+  /// The name of the property for the bytes every key starts with.
+  ///
+  static const std::string KEY_PREFIX_PROPERTY;
+  static const std::string KEY_PREFIX_DEFAULT;
+
+  ///
+  /// The name of the property for the total key length in bytes, prefix
+  /// included. 0 means zeropadding digits for decimal, 16 digits for hex
+  /// and 8 bytes for binary. Decimal keys only pad up to it, so it is a
+  /// minimum for them. Hex and binary keys are exactly that long, and Init
+  /// rejects a length too short for every key number: hashed keys need 16
+  /// digits or 8 bytes.
+  ///
+  static const std::string KEY_LENGTH_PROPERTY;
+  static const std::string KEY_LENGTH_DEFAULT;
+
   /// 
   /// The name of the property for the max scan length (number of records).
   ///
@@ -136,6 +281,17 @@ class CoreWorkload {
 
   static const std::string INSERT_START_PROPERTY;
   static const std::string INSERT_START_DEFAULT;
+
+  ///
+  /// The names of the properties for splitting the keys to load and insert
+  /// among several processes: this one takes the key numbers congruent to
+  /// keypartition.index modulo keypartition.count, for transactions as well
+  /// as for loading. Not supported with churn.
+  ///
+  static const std::string KEY_PARTITION_INDEX_PROPERTY;
+  static const std::string KEY_PARTITION_INDEX_DEFAULT;
+  static const std::string KEY_PARTITION_COUNT_PROPERTY;
+  static const std::string KEY_PARTITION_COUNT_DEFAULT;
   
   static const std::string RECORD_COUNT_PROPERTY;
   static const std::string OPERATION_COUNT_PROPERTY;
@@ -152,37 +308,101 @@ class CoreWorkload {
   virtual std::string NextTable() { return table_name_; }
   virtual std::string NextSequenceKey(); /// Used for loading data
   virtual std::string NextTransactionKey(); /// Used for transactions
+  ///
+  /// Draws n key numbers at once for later TransactionKeyName calls,
+  /// which lets clients refill a buffer with one generator call.
+  ///
+  virtual void NextTransactionKeyNums(uint64_t *key_nums, std::size_t n) {
+    key_chooser_->NextN(key_nums, n);
+  }
+  virtual std::string TransactionKeyName(uint64_t key_num);
+  ///
+  /// Like TransactionKeyName, but redraws until the key matches readtarget,
+  /// giving up after a few tries.
+  ///
+  virtual std::string ReadKeyName(uint64_t key_num);
+  ///
+  /// Picks a key to delete and marks it deleted.
+  ///
+  virtual std::string NextDeleteKey();
   virtual Operation NextOperation() { return op_chooser_.Next(); }
   virtual std::string NextFieldName();
   virtual size_t NextScanLength() { return scan_len_chooser_->Next(); }
   
-  bool read_all_fields() const { return read_all_fields_; }
-  bool write_all_fields() const { return write_all_fields_; }
+  ///
+  /// Returns the number of the next key to insert, from which a following
+  /// phase of the run continues.
+  ///
+  uint64_t NextInsertKeyNum() {
+    return key_generator_->Last() + partition_count_ - partition_index_;
+  }
+  uint64_t OldestKeyNum() const { return oldest_key_.load(); }
+
+  ///
+  /// Sets the properties with which a following phase picks up the keys
+  /// this workload inserted and deleted.
+  ///
+  virtual void CarryOver(utils::Properties &next);
+
+  /// The number of records this process loads.
+  virtual size_t record_count() const {
+    return record_count_ / partition_count_ +
+        (partition_index_ < record_count_ % partition_count_);
+  }
+  virtual bool churn() const { return churn_; }
+  virtual bool read_all_fields() const { return read_all_fields_; }
+  virtual bool write_all_fields() const { return write_all_fields_; }
 
   CoreWorkload() :
       field_count_(0), read_all_fields_(false), write_all_fields_(false),
-      field_len_generator_(NULL), key_generator_(NULL), key_chooser_(NULL),
+      field_len_generator_(NULL), value_generator_(NULL),
+      key_generator_(NULL), key_chooser_(NULL),
       field_chooser_(NULL), scan_len_chooser_(NULL), insert_key_sequence_(3),
-      ordered_inserts_(true), record_count_(0) {
+      ordered_inserts_(true), record_count_(0), partition_index_(0),
+      partition_count_(1), key_format_(DECIMAL_KEY),
+      key_width_(0), read_target_(ANY_KEY),
+      churn_(false), churn_start_(0), oldest_key_(0), deleted_(NULL),
+      num_tracked_(0) {
   }
   
   virtual ~CoreWorkload() {
     if (field_len_generator_) delete field_len_generator_;
+    if (value_generator_) delete value_generator_;
     if (key_generator_) delete key_generator_;
     if (key_chooser_) delete key_chooser_;
     if (field_chooser_) delete field_chooser_;
     if (scan_len_chooser_) delete scan_len_chooser_;
+    delete[] deleted_;
   }
   
  protected:
-  static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p);
+  ///
+  /// Returns the field length generator, and the longest length it can
+  /// produce in max_len.
+  ///
+  static Generator<uint64_t> *GetFieldLenGenerator(const utils::Properties &p,
+                                                   uint64_t &max_len);
+  /// Returns len bytes of value, sliced from the shared value buffer.
+  std::string_view NextValue(std::size_t len) const {
+    return value_generator_->Next(len);
+  }
   std::string BuildKeyName(uint64_t key_num);
 
+  enum KeyFormat { DECIMAL_KEY, HEX_KEY, BINARY_KEY };
+  enum ReadTarget { ANY_KEY, LIVE_KEY, DELETED_KEY };
+  static const int kMaxRedraws = 16;
+
+  /// Maps a drawn key number onto a key that has been inserted.
+  uint64_t TransactionKeyNum(uint64_t key_num);
+  bool IsDeleted(uint64_t key_num) const;
+  void MarkDeleted(uint64_t key_num);
+
   std::string table_name_;
   int field_count_;
   bool read_all_fields_;
   bool write_all_fields_;
   Generator<uint64_t> *field_len_generator_;
+  ValueGenerator *value_generator_;
   Generator<uint64_t> *key_generator_;
   DiscreteGenerator<Operation> op_chooser_;
   Generator<uint64_t> *key_chooser_;
@@ -191,19 +411,99 @@ class CoreWorkload {
   CounterGenerator insert_key_sequence_;
   bool ordered_inserts_;
   size_t record_count_;
+  size_t partition_index_;
+  size_t partition_count_;
   int zero_padding_;
+  KeyFormat key_format_;
+  std::string key_prefix_;
+  std::size_t key_width_; ///< Digits or bytes after the prefix
+  ReadTarget read_target_;
+  bool churn_;
+  uint64_t churn_start_;             ///< The oldest live key at the start
+  std::atomic<uint64_t> oldest_key_; ///< Keys below were deleted by churn
+  std::atomic<uint64_t> *deleted_;   ///< Bitmap of deleted key numbers
+  uint64_t num_tracked_;             ///< Keys covered by the bitmap
 };
 
+inline void CoreWorkload::CarryOver(utils::Properties &next) {
+  const std::string next_key = std::to_string(NextInsertKeyNum());
+  next.SetProperty(RECORD_COUNT_PROPERTY, next_key);
+  next.SetProperty(INSERT_START_PROPERTY, next_key);
+  next.SetProperty(CHURN_START_PROPERTY, std::to_string(OldestKeyNum()));
+}
+
 inline std::string CoreWorkload::NextSequenceKey() {
   uint64_t key_num = key_generator_->Next();
   return BuildKeyName(key_num);
 }
 
 inline std::string CoreWorkload::NextTransactionKey() {
-  uint64_t key_num;
-  do {
+  return TransactionKeyName(key_chooser_->Next());
+}
+
+inline uint64_t CoreWorkload::TransactionKeyNum(uint64_t key_num) {
+  if (!churn_) {
+    // Moves keys into this partition, and redraws keys that have not been
+    // inserted yet.
+    for (;;) {
+      if (partition_count_ > 1) {
+        key_num += partition_index_ - key_num % partition_count_;
+      }
+      if (key_num <= insert_key_sequence_.Last()) return key_num;
+      key_num = key_chooser_->Next();
+    }
+  }
+  // Draws count from the oldest live key, and past the newest are redrawn.
+  const uint64_t oldest = oldest_key_.load(std::memory_order_relaxed);
+  const uint64_t newest = key_generator_->Last();
+  if (oldest > newest) return newest; // Every record has been deleted
+  while (oldest + key_num > newest) {
     key_num = key_chooser_->Next();
-  } while (key_num > insert_key_sequence_.Last());
+  }
+  return oldest + key_num;
+}
+
+inline std::string CoreWorkload::TransactionKeyName(uint64_t key_num) {
+  return BuildKeyName(TransactionKeyNum(key_num));
+}
+
+inline std::string CoreWorkload::ReadKeyName(uint64_t key_num) {
+  if (read_target_ == ANY_KEY) return TransactionKeyName(key_num);
+  if (churn_ && read_target_ == DELETED_KEY) {
+    // Churn deletes in key order, and request keys only reach live ones,
+    // so draws from the keys this phase expired, if any yet.
+    const uint64_t oldest = oldest_key_.load(std::memory_order_relaxed);
+    if (oldest > churn_start_) {
+      return BuildKeyName(churn_start_ + key_num % (oldest - churn_start_));
+    }
+  }
+  key_num = TransactionKeyNum(key_num);
+  for (int i = 0; i < kMaxRedraws &&
+       IsDeleted(key_num) != (read_target_ == DELETED_KEY); ++i) {
+    key_num = TransactionKeyNum(key_chooser_->Next());
+  }
+  return BuildKeyName(key_num);
+}
+
+inline bool CoreWorkload::IsDeleted(uint64_t key_num) const {
+  if (key_num < oldest_key_.load(std::memory_order_relaxed)) return true;
+  if (key_num >= num_tracked_) return false;
+  return deleted_[key_num / 64].load(std::memory_order_relaxed) &
+      (uint64_t(1) << key_num % 64);
+}
+
+inline void CoreWorkload::MarkDeleted(uint64_t key_num) {
+  if (key_num >= num_tracked_) return;
+  deleted_[key_num / 64].fetch_or(uint64_t(1) << key_num % 64,
+                                  std::memory_order_relaxed);
+}
+
+inline std::string CoreWorkload::NextDeleteKey() {
+  if (churn_) {
+    return BuildKeyName(oldest_key_.fetch_add(1, std::memory_order_relaxed));
+  }
+  const uint64_t key_num = TransactionKeyNum(key_chooser_->Next());
+  MarkDeleted(key_num);
   return BuildKeyName(key_num);
 }
 
@@ -211,10 +511,26 @@ inline std::string CoreWorkload::BuildKeyName(uint64_t key_num) {
   if (!ordered_inserts_) {
     key_num = utils::Hash(key_num);
   }
-  std::string key_num_str = std::to_string(key_num);
-  int zeros = zero_padding_ - key_num_str.length();
-  zeros = std::max(0, zeros);
-  return std::string("user").append(zeros, '0').append(key_num_str);
+  std::string key(key_prefix_);
+  if (key_format_ == DECIMAL_KEY) {
+    std::string key_num_str = std::to_string(key_num);
+    int zeros = key_width_ - key_num_str.length();
+    zeros = std::max(0, zeros);
+    return key.append(zeros, '0').append(key_num_str);
+  }
+  // Fills the fixed width from the least significant end.
+  key.resize(key_prefix_.size() + key_width_, '0');
+  char *p = &key[0] + key.size();
+  if (key_format_ == HEX_KEY) {
+    for (std::size_t i = 0; i < key_width_ && i < 16; ++i) {
+      *--p = "0123456789abcdef"[key_num >> 4 * i & 0xf];
+    }
+  } else {
+    for (std::size_t i = 0; i < key_width_; ++i) {
+      *--p = i < 8 ? char(key_num >> 8 * i) : '\0';
+    }
+  }
+  return key;
 }
 
 inline std::string CoreWorkload::NextFieldName() {
@@ -16,14 +16,25 @@
 
 namespace ycsbc {
 
+///
+/// Counts up from start in steps of stride, so that generators with the
+/// same stride and starts that differ modulo stride never meet.
+///
 class CounterGenerator : public Generator<uint64_t> {
  public:
-  CounterGenerator(uint64_t start) : counter_(start) { }
-  uint64_t Next() { return counter_.fetch_add(1); }
-  uint64_t Last() { return counter_.load() - 1; }
+  CounterGenerator(uint64_t start, uint64_t stride = 1) :
+      counter_(start), stride_(stride) { }
+  uint64_t Next() { return counter_.fetch_add(stride_); }
+  uint64_t Last() { return counter_.load() - stride_; }
   void Set(uint64_t start) { counter_.store(start); }
+
+  void NextN(uint64_t *out, std::size_t n) {
+    uint64_t start = counter_.fetch_add(n * stride_);
+    for (std::size_t i = 0; i < n; ++i) out[i] = start + i * stride_;
+  }
  private:
   std::atomic<uint64_t> counter_;
+  const uint64_t stride_;
 };
 
 } // ycsbc
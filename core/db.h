@@ -9,11 +9,15 @@
 #ifndef YCSB_C_DB_H_
 #define YCSB_C_DB_H_
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
 namespace ycsbc {
 
+///
+/// Keys and values are byte strings: they may hold any byte, '\0' included.
+///
 class DB {
  public:
   typedef std::pair<std::string, std::string> KVPair;
@@ -89,7 +93,13 @@ class DB {
   /// @return Zero on success, a non-zero error code on error.
   ///
   virtual int Delete(const std::string &table, const std::string &key) = 0;
-  
+  ///
+  /// Estimates the memory the database holds for its records.
+  ///
+  /// @return The estimate in bytes, or zero if the database cannot tell.
+  ///
+  virtual uint64_t MemoryUsage() { return 0; }
+
   virtual ~DB() { }
 };
 
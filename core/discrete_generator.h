@@ -13,52 +13,88 @@
 
 #include <atomic>
 #include <cassert>
-#include <mutex>
+#include <cstdint>
 #include <vector>
+#include "alias_table.h"
 #include "utils.h"
 
 namespace ycsbc {
 
+///
+/// Picks among weighted values through an AliasTable. Values must all be
+/// added, and then Build called once, before the first Next; after that,
+/// Next takes no lock and runs in constant time. Last returns the value the
+/// calling thread drew last, so that threads never write shared memory.
+/// Each thread keeps its draws in a few slots picked by generator id, so
+/// Last falls back to the first value if another generator of the same
+/// slot drew since.
+///
 template <typename Value>
 class DiscreteGenerator : public Generator<Value> {
  public:
-  DiscreteGenerator() : sum_(0) { }
+  DiscreteGenerator() : id_(++next_id_) { }
+
   void AddValue(Value value, double weight);
+  ///
+  /// Builds the table of the values added so far. Throws utils::Exception
+  /// if a weight is negative or they sum to zero.
+  ///
+  void Build();
 
   Value Next();
-  Value Last() { return last_; }
+  Value Last();
 
  private:
-  std::vector<std::pair<Value, double>> values_;
-  double sum_;
-  std::atomic<Value> last_;
-  std::mutex mutex_;
+  static const std::size_t kSlots = 16;
+
+  /// The last draw of the calling thread from the generator id, 0 if none.
+  struct Draw {
+    uint64_t id;
+    Value value;
+  };
+
+  static Draw &ThreadSlot(uint64_t id) {
+    static thread_local Draw slots[kSlots] = {};
+    return slots[id % kSlots];
+  }
+
+  static std::atomic<uint64_t> next_id_;
+
+  const uint64_t id_;  ///< Never reused, unlike the address
+  std::vector<Value> values_;
+  std::vector<double> weights_;
+  AliasTable table_;
 };
 
+template <typename Value>
+std::atomic<uint64_t> DiscreteGenerator<Value>::next_id_{0};
+
 template <typename Value>
 inline void DiscreteGenerator<Value>::AddValue(Value value, double weight) {
-  if (values_.empty()) {
-    last_ = value;
-  }
-  values_.push_back(std::make_pair(value, weight));
-  sum_ += weight;
+  values_.push_back(value);
+  weights_.push_back(weight);
+}
+
+template <typename Value>
+inline void DiscreteGenerator<Value>::Build() {
+  table_.Build(weights_);
 }
 
 template <typename Value>
 inline Value DiscreteGenerator<Value>::Next() {
-  mutex_.lock();
-  double chooser = utils::RandomDouble();
-  mutex_.unlock();
-  
-  for (auto p = values_.cbegin(); p != values_.cend(); ++p) {
-    if (chooser < p->second / sum_) {
-      return last_ = p->first;
-    }
-    chooser -= p->second / sum_;
-  }
-  
-  assert(false);
-  return last_;
+  assert(table_.size() == values_.size() && !values_.empty());
+  Value value = values_[table_.Sample(utils::ThreadLocalRandom64())];
+  Draw &slot = ThreadSlot(id_);
+  slot.id = id_;
+  slot.value = value;
+  return value;
+}
+
+template <typename Value>
+inline Value DiscreteGenerator<Value>::Last() {
+  assert(!values_.empty());
+  const Draw &slot = ThreadSlot(id_);
+  return slot.id == id_ ? slot.value : values_.front();
 }
 
 } // ycsbc
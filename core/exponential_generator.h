@@ -0,0 +1,62 @@
+//
+//  exponential_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_EXPONENTIAL_GENERATOR_H_
+#define YCSB_C_EXPONENTIAL_GENERATOR_H_
+
+#include "generator.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include "counter_generator.h"
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Favors recently inserted items: the distance back from the latest item
+/// in basis is exponentially distributed, with percentile percent of draws
+/// falling within the latest range items. Draws reaching past the first
+/// item are redrawn. This matches upstream YCSB's ExponentialGenerator as
+/// CoreWorkload applies it.
+///
+class ExponentialGenerator : public Generator<uint64_t> {
+ public:
+  ExponentialGenerator(CounterGenerator &basis, double percentile,
+                       double range) :
+      basis_(basis), gamma_(-std::log(1.0 - percentile / 100.0) / range) {
+    Next();
+  }
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  CounterGenerator &basis_;
+  const double gamma_;
+  std::atomic<uint64_t> last_;
+};
+
+inline uint64_t ExponentialGenerator::Next() {
+  const uint64_t latest = basis_.Last();
+  uint64_t offset;
+  do {
+    // 1 - u lies in (0, 1], so the log is finite.
+    double u = utils::ToUnitDouble(utils::ThreadLocalRandom64());
+    // Truncates before comparing, as upstream does, so that item 0 gets
+    // the whole last unit of the range. Larger distances are capped first
+    // so that the cast cannot overflow.
+    const double distance = -std::log(1.0 - u) / gamma_;
+    offset = distance < latest + 1.0 ? (uint64_t)distance : latest + 1;
+  } while (offset > latest);
+  uint64_t value = latest - offset;
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+} // ycsbc
+
+#endif // YCSB_C_EXPONENTIAL_GENERATOR_H_
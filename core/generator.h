@@ -9,6 +9,7 @@
 #ifndef YCSB_C_GENERATOR_H_
 #define YCSB_C_GENERATOR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -19,6 +20,15 @@ class Generator {
  public:
   virtual Value Next() = 0;
   virtual Value Last() = 0;
+
+  ///
+  /// Fills out with the next n values. Generators override this where
+  /// drawing a batch is cheaper than n calls to Next.
+  ///
+  virtual void NextN(Value *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = Next();
+  }
+
   virtual ~Generator() { }
 };
 
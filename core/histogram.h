@@ -0,0 +1,158 @@
+//
+//  histogram.h
+//  YCSB-C
+//
+//  A log-linear latency histogram that one thread fills and any can read.
+//
+
+#ifndef YCSB_C_HISTOGRAM_H_
+#define YCSB_C_HISTOGRAM_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include "utils.h"
+
+namespace utils {
+
+///
+/// Values below 32 get a bucket each; above, every power of two is split
+/// into 32 buckets, so a bucket spans at most 1/32 of its values. Add() is
+/// for a single writer and takes no atomic read-modify-write, while other
+/// threads may take a consistent-enough copy with Merge() at any time.
+///
+class Histogram {
+ public:
+  Histogram() { Clear(); }
+
+  void Add(uint64_t value);
+  /// Adds the counts of other to this histogram, which must not be in use.
+  void Merge(const Histogram &other);
+  void Clear();
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+  double Mean() const;
+  /// Returns the upper bound of the bucket holding the p-th percentile.
+  uint64_t Percentile(double p) const;
+
+  ///
+  /// Writes the histogram as space-separated numbers on one line: count,
+  /// sum, max, then index:count for each non-empty bucket.
+  ///
+  std::string Serialize() const;
+  /// Reads what Serialize() wrote, adding it to this histogram.
+  void Deserialize(std::istream &input);
+
+ private:
+  static const int kSubBits = 5;
+  static const uint64_t kSubBuckets = 1 << kSubBits;
+  static const std::size_t kNumBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+  static std::size_t Index(uint64_t value);
+  static uint64_t UpperBound(std::size_t index);
+
+  void Store(std::atomic<uint64_t> &slot, uint64_t value) {
+    slot.store(value, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> buckets_[kNumBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+inline std::size_t Histogram::Index(uint64_t value) {
+  if (value < kSubBuckets) return value;
+  const int exponent = 63 - __builtin_clzll(value);
+  const uint64_t sub = (value >> (exponent - kSubBits)) & (kSubBuckets - 1);
+  return (exponent - kSubBits + 1) * kSubBuckets + sub;
+}
+
+inline uint64_t Histogram::UpperBound(std::size_t index) {
+  if (index < kSubBuckets) return index;
+  const int exponent = index / kSubBuckets + kSubBits - 1;
+  const uint64_t sub = index % kSubBuckets;
+  const uint64_t low = (kSubBuckets + sub) << (exponent - kSubBits);
+  return low + (uint64_t(1) << (exponent - kSubBits)) - 1;
+}
+
+inline void Histogram::Add(uint64_t value) {
+  std::atomic<uint64_t> &bucket = buckets_[Index(value)];
+  Store(bucket, bucket.load(std::memory_order_relaxed) + 1);
+  Store(count_, count_.load(std::memory_order_relaxed) + 1);
+  Store(sum_, sum_.load(std::memory_order_relaxed) + value);
+  if (value > max_.load(std::memory_order_relaxed)) Store(max_, value);
+}
+
+inline void Histogram::Merge(const Histogram &other) {
+  for (std::size_t i = 0; i < kNumBuckets; ++i) {
+    const uint64_t n = other.buckets_[i].load(std::memory_order_relaxed);
+    if (n) Store(buckets_[i], buckets_[i].load(std::memory_order_relaxed) + n);
+  }
+  Store(count_, count() + other.count());
+  Store(sum_, sum_.load(std::memory_order_relaxed) +
+              other.sum_.load(std::memory_order_relaxed));
+  Store(max_, std::max(max(), other.max()));
+}
+
+inline void Histogram::Clear() {
+  for (std::atomic<uint64_t> &bucket : buckets_) Store(bucket, 0);
+  Store(count_, 0);
+  Store(sum_, 0);
+  Store(max_, 0);
+}
+
+inline double Histogram::Mean() const {
+  return count() ? (double)sum_.load(std::memory_order_relaxed) / count() : 0;
+}
+
+inline uint64_t Histogram::Percentile(double p) const {
+  // Counts the buckets themselves, which a concurrent Add() may leave
+  // briefly ahead of count_.
+  uint64_t total = 0;
+  for (const std::atomic<uint64_t> &bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  const uint64_t rank = std::max<uint64_t>(total * p / 100, 1);
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) return std::min(UpperBound(i), max());
+  }
+  return max();
+}
+
+inline std::string Histogram::Serialize() const {
+  std::ostringstream out;
+  out << count() << ' ' << sum_.load(std::memory_order_relaxed) << ' '
+      << max();
+  for (std::size_t i = 0; i < kNumBuckets; ++i) {
+    const uint64_t n = buckets_[i].load(std::memory_order_relaxed);
+    if (n) out << ' ' << i << ':' << n;
+  }
+  return out.str();
+}
+
+inline void Histogram::Deserialize(std::istream &input) {
+  uint64_t count, sum, max;
+  if (!(input >> count >> sum >> max)) {
+    throw Exception("Bad histogram");
+  }
+  Store(count_, this->count() + count);
+  Store(sum_, sum_.load(std::memory_order_relaxed) + sum);
+  Store(max_, std::max(this->max(), max));
+  std::size_t index;
+  char colon;
+  uint64_t n;
+  while (input >> index >> colon >> n) {
+    if (colon != ':' || index >= kNumBuckets) throw Exception("Bad histogram");
+    Store(buckets_[index], buckets_[index].load(std::memory_order_relaxed) + n);
+  }
+}
+
+} // utils
+
+#endif // YCSB_C_HISTOGRAM_H_
@@ -0,0 +1,75 @@
+//
+//  hotspot_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_HOTSPOT_GENERATOR_H_
+#define YCSB_C_HOTSPOT_GENERATOR_H_
+
+#include "generator.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// Splits [min, max] into a hot set at the bottom, holding hot_set_fraction
+/// of the items, and a cold set above it. A draw lands in the hot set with
+/// probability hot_op_fraction and is uniform within the chosen set, as in
+/// upstream YCSB's HotspotIntegerGenerator.
+///
+class HotspotGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  HotspotGenerator(uint64_t min, uint64_t max, double hot_set_fraction,
+                   double hot_op_fraction);
+
+  uint64_t Next();
+  uint64_t Last() { return last_.load(std::memory_order_relaxed); }
+
+ private:
+  static uint64_t Scale(uint64_t bits, uint64_t range) {
+    return (uint64_t)(((unsigned __int128)bits * range) >> 64);
+  }
+
+  uint64_t min_;
+  uint64_t hot_items_;
+  uint64_t cold_items_;
+  uint64_t hot_threshold_; ///< Random bits below this pick the hot set
+  std::atomic<uint64_t> last_;
+};
+
+inline HotspotGenerator::HotspotGenerator(uint64_t min, uint64_t max,
+    double hot_set_fraction, double hot_op_fraction) : min_(min) {
+  assert(max >= min);
+  if (hot_set_fraction < 0 || hot_set_fraction > 1) hot_set_fraction = 0;
+  if (hot_op_fraction < 0 || hot_op_fraction > 1) hot_op_fraction = 0;
+  const uint64_t items = max - min + 1;
+  hot_items_ = items * hot_set_fraction;
+  cold_items_ = items - hot_items_;
+  // Without one of the sets, every draw goes to the other.
+  if (hot_items_ == 0) hot_op_fraction = 0;
+  if (cold_items_ == 0) hot_op_fraction = 1;
+  hot_threshold_ = hot_op_fraction >= 1 ? UINT64_MAX :
+      (uint64_t)(hot_op_fraction * 18446744073709551616.0);
+  Next();
+}
+
+inline uint64_t HotspotGenerator::Next() {
+  uint64_t value;
+  if (utils::ThreadLocalRandom64() < hot_threshold_) {
+    value = min_ + Scale(utils::ThreadLocalRandom64(), hot_items_);
+  } else {
+    value = min_ + hot_items_ +
+        Scale(utils::ThreadLocalRandom64(), cold_items_);
+  }
+  last_.store(value, std::memory_order_relaxed);
+  return value;
+}
+
+} // ycsbc
+
+#endif // YCSB_C_HOTSPOT_GENERATOR_H_
@@ -0,0 +1,49 @@
+//
+//  mem_stats.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_MEM_STATS_H_
+#define YCSB_C_MEM_STATS_H_
+
+#include <malloc.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace utils {
+
+///
+/// Process-wide memory figures, all in bytes.
+///
+struct MemStats {
+  uint64_t rss;       ///< Resident set size
+  uint64_t peak_rss;  ///< High-water mark of the resident set size
+  uint64_t heap;      ///< Bytes handed out by malloc and not yet freed
+};
+
+inline MemStats SampleMemory() {
+  MemStats stats = {0, 0, 0};
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    // Lines read e.g. "VmRSS:     1234 kB".
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      stats.rss = std::stoull(line.substr(6)) << 10;
+    } else if (line.compare(0, 6, "VmHWM:") == 0) {
+      stats.peak_rss = std::stoull(line.substr(6)) << 10;
+    }
+  }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 info = mallinfo2();
+  stats.heap = info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+  struct mallinfo info = mallinfo();
+  stats.heap = (unsigned)info.uordblks + (unsigned)info.hblkhd;
+#endif
+  return stats;
+}
+
+} // utils
+
+#endif // YCSB_C_MEM_STATS_H_
@@ -0,0 +1,100 @@
+//
+//  multi_table_workload.cc
+//  YCSB-C
+//
+
+#include "multi_table_workload.h"
+
+#include <algorithm>
+#include <sstream>
+
+using ycsbc::MultiTableWorkload;
+using std::string;
+
+const string MultiTableWorkload::TABLES_PROPERTY = "tables";
+
+const string MultiTableWorkload::TABLE_WEIGHT_PROPERTY = "weight";
+const string MultiTableWorkload::TABLE_WEIGHT_DEFAULT = "1";
+
+void MultiTableWorkload::Init(const utils::Properties &p) {
+  record_count_ = 0;
+  std::stringstream ss(p.GetProperty(TABLES_PROPERTY));
+  string name;
+  while (std::getline(ss, name, ',')) {
+    name = utils::Trim(name);
+    if (name.empty()) continue;
+    const utils::Properties table_props = TableProperties(p, name);
+    const double weight = std::stod(table_props.GetProperty(
+        TABLE_WEIGHT_PROPERTY, TABLE_WEIGHT_DEFAULT));
+    if (weight < 0) throw utils::Exception("Negative weight for " + name);
+
+    CoreWorkload *table = new CoreWorkload;
+    tables_.push_back(table);
+    table->Init(table_props);
+    names_.push_back(name);
+    record_count_ += table->record_count();
+    load_ends_.push_back(record_count_);
+    table_chooser_.AddValue(tables_.size() - 1, weight);
+  }
+  if (tables_.empty()) {
+    throw utils::Exception("No tables in: " + p.GetProperty(TABLES_PROPERTY));
+  }
+  table_chooser_.Build();
+}
+
+void MultiTableWorkload::CarryOver(utils::Properties &next) {
+  for (std::size_t i = 0; i < tables_.size(); ++i) {
+    utils::Properties carried;
+    tables_[i]->CarryOver(carried);
+    for (const auto &prop : carried.properties()) {
+      next.SetProperty(names_[i] + "." + prop.first, prop.second);
+    }
+  }
+}
+
+utils::Properties MultiTableWorkload::TableProperties(
+    const utils::Properties &p, const string &name) {
+  utils::Properties table_props = p;
+  const string prefix = name + ".";
+  for (const auto &prop : p.properties()) {
+    if (prop.first.compare(0, prefix.size(), prefix) == 0) {
+      table_props.SetProperty(prop.first.substr(prefix.size()), prop.second);
+    }
+  }
+  table_props.SetProperty(TABLENAME_PROPERTY, name);
+  return table_props;
+}
+
+string MultiTableWorkload::NextSequenceKey() {
+  Cursor &c = LocalCursor();
+  if (!c.issuing) {
+    // Loading: the i-th record goes to the table whose share covers it.
+    const uint64_t i = loaded_.fetch_add(1, std::memory_order_relaxed);
+    c.table = std::upper_bound(load_ends_.begin(), load_ends_.end(), i) -
+        load_ends_.begin();
+    c.table = std::min(c.table, tables_.size() - 1);
+  }
+  return tables_[c.table]->NextSequenceKey();
+}
+
+void MultiTableWorkload::NextTransactionKeyNums(uint64_t *key_nums,
+                                                std::size_t n) {
+  std::fill(key_nums, key_nums + n, 0); // Each table draws its own keys
+}
+
+string MultiTableWorkload::TransactionKeyName(uint64_t key_num) {
+  return Current().NextTransactionKey();
+}
+
+string MultiTableWorkload::ReadKeyName(uint64_t key_num) {
+  CoreWorkload &table = Current();
+  table.NextTransactionKeyNums(&key_num, 1);
+  return table.ReadKeyName(key_num);
+}
+
+ycsbc::Operation MultiTableWorkload::NextOperation() {
+  Cursor &c = LocalCursor();
+  c.table = table_chooser_.Next();
+  c.issuing = true;
+  return tables_[c.table]->NextOperation();
+}
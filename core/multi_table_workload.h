@@ -0,0 +1,114 @@
+//
+//  multi_table_workload.h
+//  YCSB-C
+//
+//  Spreads a run over several tables, each with a workload of its own.
+//
+
+#ifndef YCSB_C_MULTI_TABLE_WORKLOAD_H_
+#define YCSB_C_MULTI_TABLE_WORKLOAD_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+
+namespace ycsbc {
+
+///
+/// Every table gets a CoreWorkload of its own, initialized with the base
+/// properties overlaid with those prefixed by the table name, so that
+/// "orders.recordcount=1000" or "orders.fieldlength=400" apply to the
+/// orders table only. NextOperation() picks the table of each operation by
+/// weight, and the other calls of that operation go to its workload.
+/// Loading fills the tables one after another, each with its own
+/// recordcount.
+///
+class MultiTableWorkload : public CoreWorkload {
+ public:
+  ///
+  /// The name of the property for the comma-separated names of the tables.
+  ///
+  static const std::string TABLES_PROPERTY;
+
+  ///
+  /// The name of the per-table property, after "<table>.", for the relative
+  /// weight with which operations go to the table.
+  ///
+  static const std::string TABLE_WEIGHT_PROPERTY;
+  static const std::string TABLE_WEIGHT_DEFAULT;
+
+  void Init(const utils::Properties &p);
+  void CarryOver(utils::Properties &next);
+
+  void BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
+    Current().BuildValues(values);
+  }
+  void BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
+    Current().BuildUpdate(update);
+  }
+
+  std::string NextTable() { return names_[LocalCursor().table]; }
+  std::string NextSequenceKey();
+  std::string NextTransactionKey() { return Current().NextTransactionKey(); }
+  void NextTransactionKeyNums(uint64_t *key_nums, std::size_t n);
+  std::string TransactionKeyName(uint64_t key_num);
+  std::string ReadKeyName(uint64_t key_num);
+  std::string NextDeleteKey() { return Current().NextDeleteKey(); }
+  Operation NextOperation();
+  std::string NextFieldName() { return Current().NextFieldName(); }
+  size_t NextScanLength() { return Current().NextScanLength(); }
+
+  size_t record_count() const { return record_count_; }
+  bool churn() const { return Current().churn(); }
+  bool read_all_fields() const { return Current().read_all_fields(); }
+  bool write_all_fields() const { return Current().write_all_fields(); }
+
+  MultiTableWorkload() : loaded_(0) { }
+  ~MultiTableWorkload() {
+    for (CoreWorkload *table : tables_) delete table;
+  }
+
+ private:
+  ///
+  /// The table of the operation a thread is issuing. Loading picks a table
+  /// per record without an operation, which leaves issuing false.
+  ///
+  struct Cursor {
+    const MultiTableWorkload *owner = NULL;
+    std::size_t table = 0;
+    bool issuing = false;
+  };
+
+  static Cursor &ThreadCursor() {
+    static thread_local Cursor cursor;
+    return cursor;
+  }
+
+  Cursor &LocalCursor() const;
+  CoreWorkload &Current() const { return *tables_[LocalCursor().table]; }
+
+  /// Returns p overlaid with the properties prefixed by "<name>.".
+  static utils::Properties TableProperties(const utils::Properties &p,
+                                           const std::string &name);
+
+  std::vector<std::string> names_;
+  std::vector<CoreWorkload *> tables_;
+  std::vector<uint64_t> load_ends_; ///< Table i loads [ends[i-1], ends[i])
+  DiscreteGenerator<std::size_t> table_chooser_;
+  std::atomic<uint64_t> loaded_;
+};
+
+inline MultiTableWorkload::Cursor &MultiTableWorkload::LocalCursor() const {
+  Cursor &cursor = ThreadCursor();
+  if (cursor.owner != this) {
+    cursor.owner = this;
+    cursor.table = 0;
+    cursor.issuing = false;
+  }
+  return cursor;
+}
+
+} // ycsbc
+
+#endif // YCSB_C_MULTI_TABLE_WORKLOAD_H_
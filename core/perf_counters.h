@@ -0,0 +1,124 @@
+//
+//  perf_counters.h
+//  YCSB-C
+//
+//  Hardware and software event counts of a thread through perf_event_open.
+//
+
+#ifndef YCSB_C_PERF_COUNTERS_H_
+#define YCSB_C_PERF_COUNTERS_H_
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+
+namespace utils {
+
+///
+/// Counts events of the calling thread from construction on, as one group
+/// so that all counts cover the same span. Events the machine or the
+/// kernel's perf_event_paranoid setting refuse are left out; on a host
+/// without a PMU, as in many VMs, only the software events count. Counts
+/// are scaled up for the time the group was multiplexed off the PMU.
+///
+class PerfCounters {
+ public:
+  enum Event {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    CONTEXT_SWITCHES,
+    kNumEvents
+  };
+
+  static const char *EventName(int event) {
+    static const char *names[kNumEvents] = {
+      "cycles", "instructions", "cache_misses", "branch_misses",
+      "context_switches"
+    };
+    return names[event];
+  }
+
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// Returns a bit per event that is counted.
+  unsigned available() const { return available_; }
+  /// Reads the counts so far, leaving zeros for events not counted.
+  void Read(uint64_t counts[kNumEvents]) const;
+
+ private:
+  static int Open(uint32_t type, uint64_t config, int group_fd);
+
+  int fds_[kNumEvents];
+  uint64_t ids_[kNumEvents];
+  int leader_;
+  unsigned available_;
+};
+
+inline int PerfCounters::Open(uint32_t type, uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_hv = 1;
+  // Counts in the kernel too where allowed, which context switches need.
+  for (int exclude_kernel = 0; exclude_kernel <= 1; ++exclude_kernel) {
+    attr.exclude_kernel = exclude_kernel;
+    const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    if (fd >= 0) return fd;
+  }
+  return -1;
+}
+
+inline PerfCounters::PerfCounters() : leader_(-1), available_(0) {
+  static const struct { uint32_t type; uint64_t config; } events[kNumEvents] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+  };
+  for (int e = 0; e < kNumEvents; ++e) {
+    fds_[e] = Open(events[e].type, events[e].config, leader_);
+    if (fds_[e] < 0) continue;
+    if (leader_ < 0) leader_ = fds_[e];
+    ioctl(fds_[e], PERF_EVENT_IOC_ID, &ids_[e]);
+    available_ |= 1u << e;
+  }
+}
+
+inline PerfCounters::~PerfCounters() {
+  for (int e = 0; e < kNumEvents; ++e) {
+    if (fds_[e] >= 0) close(fds_[e]);
+  }
+}
+
+inline void PerfCounters::Read(uint64_t counts[kNumEvents]) const {
+  for (int e = 0; e < kNumEvents; ++e) counts[e] = 0;
+  if (leader_ < 0) return;
+  // Reads nr, time enabled, time running, then a value and id per event.
+  uint64_t buffer[3 + 2 * kNumEvents];
+  if (read(leader_, buffer, sizeof(buffer)) < 24 || buffer[2] == 0) return;
+  const double scale = (double)buffer[1] / buffer[2];
+  for (uint64_t i = 0; i < buffer[0] && i < kNumEvents; ++i) {
+    const uint64_t value = buffer[3 + 2 * i];
+    const uint64_t id = buffer[4 + 2 * i];
+    for (int e = 0; e < kNumEvents; ++e) {
+      if (fds_[e] >= 0 && ids_[e] == id) counts[e] = value * scale;
+    }
+  }
+}
+
+} // utils
+
+#endif // YCSB_C_PERF_COUNTERS_H_
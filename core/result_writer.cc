@@ -0,0 +1,376 @@
+//
+//  result_writer.cc
+//  YCSB-C
+//
+
+#include "result_writer.h"
+
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using ycsbc::ResultWriter;
+using std::string;
+using std::endl;
+
+const string ResultWriter::JSON_PROPERTY = "output.json";
+
+const string ResultWriter::CSV_PROPERTY = "output.csv";
+
+const string ResultWriter::INTERVAL_PROPERTY = "output.interval";
+const string ResultWriter::INTERVAL_DEFAULT = "1";
+
+const string ResultWriter::PERF_PROPERTY = "perf";
+const string ResultWriter::PERF_DEFAULT = "false";
+
+const string ResultWriter::PERF_SAMPLE_PROPERTY = "perf.sample";
+const string ResultWriter::PERF_SAMPLE_DEFAULT = "0";
+
+namespace {
+
+const char *kOperationNames[ycsbc::kNumOperations] = {
+  "INSERT", "READ", "UPDATE", "SCAN", "READMODIFYWRITE", "DELETE"
+};
+
+const double kKilo = 1000;
+
+const int kNumEvents = utils::PerfCounters::kNumEvents;
+
+/// Calls write with the name and value of every event counted in ev, and
+/// then of IPC if both cycles and instructions were counted.
+template <typename Writer>
+void ForEachEvent(const double *ev, Writer write) {
+  for (int e = 0; e < kNumEvents; ++e) {
+    if (ev[e] >= 0) write(utils::PerfCounters::EventName(e), ev[e]);
+  }
+  const int cycles = utils::PerfCounters::CYCLES;
+  const int instructions = utils::PerfCounters::INSTRUCTIONS;
+  if (ev[cycles] > 0 && ev[instructions] >= 0) {
+    write("ipc", ev[instructions] / ev[cycles]);
+  }
+}
+
+string JsonString(const string &s) {
+  std::ostringstream out;
+  out << '"';
+  for (const unsigned char c : s) {
+    switch (c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if (c < 0x20) {
+          const char *hex = "0123456789abcdef";
+          out << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+        } else {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+  return out.str();
+}
+
+string CsvField(const string &s) {
+  if (s.find_first_of(",\"\n") == string::npos) return s;
+  string quoted = "\"";
+  for (const char c : s) {
+    if (c == '"') quoted += '"';
+    quoted += c;
+  }
+  return quoted + '"';
+}
+
+/// Returns the model name of the first processor in /proc/cpuinfo.
+string CpuModel() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") != 0) continue;
+    const std::size_t colon = line.find(':');
+    if (colon != string::npos) return utils::Trim(line.substr(colon + 1));
+  }
+  return "";
+}
+
+} // namespace
+
+ResultWriter::ResultWriter(const utils::Properties &p, const string &workload) :
+    props_(p), workload_(workload),
+    json_file_(p.GetProperty(JSON_PROPERTY)),
+    csv_file_(p.GetProperty(CSV_PROPERTY)),
+    interval_(std::stod(p.GetProperty(INTERVAL_PROPERTY, INTERVAL_DEFAULT))),
+    count_events_(utils::StrToBool(p.GetProperty(PERF_PROPERTY,
+                                                 PERF_DEFAULT))),
+    sample_events_(std::stoull(p.GetProperty(PERF_SAMPLE_PROPERTY,
+                                             PERF_SAMPLE_DEFAULT))),
+    enqueue_latency_(p.GetProperty("dbname") == "redis_async"),
+    load_records_(0), load_seconds_(0) {
+  if (interval_ <= 0) {
+    throw utils::Exception("output.interval must be positive");
+  }
+  const std::time_t now = std::time(NULL);
+  std::tm utc;
+  gmtime_r(&now, &utc);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  started_ = buffer;
+}
+
+void ResultWriter::Loaded(uint64_t records, double seconds) {
+  load_records_ = records;
+  load_seconds_ = seconds;
+}
+
+ResultWriter::Sample ResultWriter::Tally(
+    const std::vector<ClientStats *> &stats, double seconds) {
+  Sample sample = {seconds, 0, 0};
+  for (const ClientStats *s : stats) {
+    sample.ops += s->ops.load(std::memory_order_relaxed);
+    sample.oks += s->oks.load(std::memory_order_relaxed);
+  }
+  return sample;
+}
+
+ResultWriter::Latency ResultWriter::Summarize(
+    const utils::Histogram &latency, uint64_t failed) {
+  Latency summary;
+  summary.count = latency.count();
+  summary.failed = failed;
+  summary.mean = latency.Mean() / kKilo;
+  summary.p50 = latency.Percentile(50) / kKilo;
+  summary.p95 = latency.Percentile(95) / kKilo;
+  summary.p99 = latency.Percentile(99) / kKilo;
+  summary.p999 = latency.Percentile(99.9) / kKilo;
+  summary.max = latency.max() / kKilo;
+  for (double &events : summary.events) events = -1;
+  return summary;
+}
+
+void ResultWriter::EventsPerOp(const std::vector<ClientStats *> &stats,
+                               int op, double events[kNumEvents]) {
+  unsigned available = ~0u;
+  uint64_t ops = 0;
+  uint64_t sums[kNumEvents] = {};
+  for (const ClientStats *s : stats) {
+    if (!s->count_events) available = 0;
+    available &= s->events_available;
+    const uint64_t *counts = op == kNumOperations ? s->events :
+        s->sampled_events[op];
+    ops += op == kNumOperations ? s->ops.load(std::memory_order_relaxed) :
+        s->samples[op];
+    for (int e = 0; e < kNumEvents; ++e) sums[e] += counts[e];
+  }
+  for (int e = 0; e < kNumEvents; ++e) {
+    events[e] = ops && stats.size() && (available >> e & 1) ?
+        (double)sums[e] / ops : -1;
+  }
+}
+
+void ResultWriter::PrintEvents(std::ostream &out,
+                               const std::vector<ClientStats *> &stats) {
+  double events[kNumEvents];
+  for (int i = 0; i <= kNumOperations; ++i) {
+    // Starts with all operations, then each kind that was sampled.
+    const int op = (i + kNumOperations) % (kNumOperations + 1);
+    EventsPerOp(stats, op, events);
+    if (*std::max_element(events, events + kNumEvents) < 0) continue;
+    if (op == kNumOperations) {
+      out << "# Events per op:";
+    } else {
+      uint64_t samples = 0;
+      for (const ClientStats *s : stats) samples += s->samples[op];
+      out << "# Events per " << kOperationNames[op] << " (" << samples
+          << " sampled):";
+    }
+    ForEachEvent(events, [&out](const char *name, double value) {
+      out << '\t' << name << ' ' << value;
+    });
+    out << endl;
+  }
+}
+
+void ResultWriter::AddPhase(const string &name, double seconds,
+                            const std::vector<ClientStats *> &stats,
+                            const std::vector<Sample> &series) {
+  Phase phase;
+  phase.name = name;
+  phase.seconds = seconds;
+  const Sample total = Tally(stats, seconds);
+  phase.ops = total.ops;
+  phase.oks = total.oks;
+  phase.series = series;
+  phase.series.push_back(total);
+
+  utils::Histogram all;
+  for (int op = 0; op < kNumOperations; ++op) {
+    utils::Histogram latency;
+    uint64_t failed = 0;
+    for (const ClientStats *s : stats) {
+      latency.Merge(s->latency[op]);
+      failed += s->failed[op].load(std::memory_order_relaxed);
+    }
+    phase.operations[op] = Summarize(latency, failed);
+    EventsPerOp(stats, op, phase.operations[op].events);
+    all.Merge(latency);
+  }
+  phase.all = Summarize(all, total.ops - total.oks);
+  EventsPerOp(stats, kNumOperations, phase.all.events);
+  phases_.push_back(phase);
+}
+
+void ResultWriter::Write() const {
+  if (!json_file_.empty()) {
+    std::ofstream out(json_file_);
+    if (!out) throw utils::Exception("Cannot write " + json_file_);
+    WriteJson(out);
+  }
+  if (!csv_file_.empty()) {
+    const bool is_new = !std::ifstream(csv_file_).good();
+    std::ofstream out(csv_file_, std::ios::app);
+    if (!out) throw utils::Exception("Cannot write " + csv_file_);
+    WriteCsv(out, is_new);
+  }
+}
+
+void ResultWriter::WriteJson(std::ostream &out) const {
+  utsname system;
+  uname(&system);
+  char host[256] = "";
+  gethostname(host, sizeof(host) - 1);
+
+  out << "{\n";
+  out << "  \"started\": " << JsonString(started_) << ",\n";
+  out << "  \"db\": " << JsonString(props_.GetProperty("dbname")) << ",\n";
+  out << "  \"workload\": " << JsonString(workload_) << ",\n";
+  out << "  \"threads\": " << props_.GetProperty("threadcount", "1") << ",\n";
+  out << "  \"latency\": "
+      << JsonString(enqueue_latency_ ? "enqueue" : "completion") << ",\n";
+  out << "  \"environment\": {\n";
+  out << "    \"host\": " << JsonString(host) << ",\n";
+  out << "    \"kernel\": " << JsonString(string(system.sysname) + " " +
+                                          system.release) << ",\n";
+  out << "    \"machine\": " << JsonString(system.machine) << ",\n";
+  out << "    \"cpu\": " << JsonString(CpuModel()) << ",\n";
+  out << "    \"cpus\": " << std::thread::hardware_concurrency() << ",\n";
+  out << "    \"compiler\": " << JsonString(__VERSION__) << "\n";
+  out << "  },\n";
+  out << "  \"config\": {";
+  const char *separator = "\n";
+  for (const auto &prop : props_.properties()) {
+    out << separator << "    " << JsonString(prop.first) << ": "
+        << JsonString(prop.second);
+    separator = ",\n";
+  }
+  out << "\n  },\n";
+  out << "  \"load\": {\"records\": " << load_records_ << ", \"seconds\": "
+      << load_seconds_ << "},\n";
+
+  uint64_t run_ops = 0;
+  double run_seconds = 0;
+  out << "  \"phases\": [";
+  separator = "\n";
+  for (const Phase &phase : phases_) {
+    run_ops += phase.ops;
+    run_seconds += phase.seconds;
+    out << separator << "    {\n";
+    out << "      \"name\": " << JsonString(phase.name) << ",\n";
+    out << "      \"seconds\": " << phase.seconds << ",\n";
+    out << "      \"ops\": " << phase.ops << ",\n";
+    out << "      \"failed\": " << phase.ops - phase.oks << ",\n";
+    out << "      \"ktps\": "
+        << (phase.seconds > 0 ? phase.ops / phase.seconds / kKilo : 0)
+        << ",\n";
+    out << "      \"operations\": {";
+    const char *op_separator = "\n";
+    for (int op = 0; op <= kNumOperations; ++op) {
+      const Latency &l = op < kNumOperations ? phase.operations[op] : phase.all;
+      if (!l.count) continue;
+      out << op_separator << "        "
+          << JsonString(op < kNumOperations ? kOperationNames[op] : "ALL")
+          << ": {\"count\": " << l.count << ", \"failed\": " << l.failed
+          << ", \"avg_us\": " << l.mean << ", \"p50_us\": " << l.p50
+          << ", \"p95_us\": " << l.p95 << ", \"p99_us\": " << l.p99
+          << ", \"p999_us\": " << l.p999 << ", \"max_us\": " << l.max;
+      WriteEventsJson(out, l.events);
+      out << "}";
+      op_separator = ",\n";
+    }
+    out << "\n      },\n";
+    out << "      \"series\": [";
+    const char *sample_separator = "";
+    Sample last = {0, 0, 0};
+    for (const Sample &sample : phase.series) {
+      const double span = sample.seconds - last.seconds;
+      out << sample_separator << "{\"seconds\": " << sample.seconds
+          << ", \"ops\": " << sample.ops << ", \"failed\": "
+          << sample.ops - sample.oks << ", \"ktps\": "
+          << (span > 0 ? (sample.ops - last.ops) / span / kKilo : 0) << "}";
+      sample_separator = ", ";
+      last = sample;
+    }
+    out << "]\n";
+    out << "    }";
+    separator = ",\n";
+  }
+  out << "\n  ],\n";
+  out << "  \"ktps\": "
+      << (run_seconds > 0 ? run_ops / run_seconds / kKilo : 0) << "\n";
+  out << "}" << endl;
+}
+
+void ResultWriter::WriteEventsJson(std::ostream &out, const double *events) {
+  bool any = false;
+  ForEachEvent(events, [&](const char *name, double value) {
+    out << (any ? ", " : ", \"events_per_op\": {") << JsonString(name)
+        << ": " << value;
+    any = true;
+  });
+  if (any) out << "}";
+}
+
+void ResultWriter::WriteCsv(std::ostream &out, bool header) const {
+  if (header) {
+    out << "started,db,workload,threads,phase,operation,count,failed,"
+           "seconds,ktps,avg_us,p50_us,p95_us,p99_us,p999_us,max_us";
+    for (int e = 0; e < kNumEvents; ++e) {
+      out << ',' << utils::PerfCounters::EventName(e) << "_per_op";
+    }
+    out << ",ipc" << endl;
+  }
+  for (const Phase &phase : phases_) {
+    for (int op = 0; op <= kNumOperations; ++op) {
+      const Latency &l = op < kNumOperations ? phase.operations[op] : phase.all;
+      if (!l.count && op < kNumOperations) continue;
+      out << started_ << ',' << CsvField(props_.GetProperty("dbname")) << ','
+          << CsvField(workload_) << ','
+          << props_.GetProperty("threadcount", "1") << ','
+          << CsvField(phase.name) << ','
+          << (op < kNumOperations ? kOperationNames[op] : "ALL") << ','
+          << l.count << ',' << l.failed << ',' << phase.seconds << ','
+          << (phase.seconds > 0 ? l.count / phase.seconds / kKilo : 0);
+      // Leaves out latencies that only time the enqueue.
+      if (enqueue_latency_) {
+        out << ",,,,,,";
+      } else {
+        out << ',' << l.mean << ',' << l.p50 << ',' << l.p95 << ','
+            << l.p99 << ',' << l.p999 << ',' << l.max;
+      }
+      // Leaves the event columns empty where not counted.
+      for (int e = 0; e < kNumEvents; ++e) {
+        out << ',';
+        if (l.events[e] >= 0) out << l.events[e];
+      }
+      out << ',';
+      const double cycles = l.events[utils::PerfCounters::CYCLES];
+      const double instructions = l.events[utils::PerfCounters::INSTRUCTIONS];
+      if (cycles > 0 && instructions >= 0) out << instructions / cycles;
+      out << endl;
+    }
+  }
+}
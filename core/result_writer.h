@@ -0,0 +1,176 @@
+//
+//  result_writer.h
+//  YCSB-C
+//
+//  Writes the results of a run as JSON and CSV for tools to read.
+//
+
+#ifndef YCSB_C_RESULT_WRITER_H_
+#define YCSB_C_RESULT_WRITER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+#include "histogram.h"
+#include "perf_counters.h"
+#include "properties.h"
+
+namespace ycsbc {
+
+///
+/// The counts and latencies of a client thread by kind of operation, which
+/// other threads may read while it runs.
+///
+struct ClientStats {
+  typedef utils::PerfCounters PerfCounters;
+
+  std::atomic<uint64_t> ops{0};
+  std::atomic<uint64_t> oks{0};
+  std::atomic<uint64_t> failed[kNumOperations];
+  utils::Histogram latency[kNumOperations]; ///< In nanoseconds
+
+  /// Whether to count events, and every how many operations to count them
+  /// for the operation alone (0 for never). Set before the thread starts.
+  bool count_events = false;
+  uint64_t sample_events = 0;
+  /// Events of the whole run of the thread and of the sampled operations,
+  /// which are only read once the thread is done.
+  unsigned events_available = 0;
+  uint64_t events[PerfCounters::kNumEvents] = {};
+  uint64_t samples[kNumOperations] = {};
+  uint64_t sampled_events[kNumOperations][PerfCounters::kNumEvents] = {};
+
+  ClientStats() {
+    for (std::atomic<uint64_t> &n : failed) n.store(0);
+  }
+};
+
+///
+/// Collects the load and every phase of a run, and writes them with the
+/// configuration and the machine they ran on. output.json names a file to
+/// hold one JSON document for the run; output.csv names a file to append a
+/// line per phase and kind of operation to, with a header if it is new.
+///
+class ResultWriter {
+ public:
+  ///
+  /// The name of the property for the file to write JSON results to.
+  ///
+  static const std::string JSON_PROPERTY;
+
+  ///
+  /// The name of the property for the file to append CSV results to.
+  ///
+  static const std::string CSV_PROPERTY;
+
+  ///
+  /// The name of the property for the seconds between the samples of the
+  /// throughput time series.
+  ///
+  static const std::string INTERVAL_PROPERTY;
+  static const std::string INTERVAL_DEFAULT;
+
+  ///
+  /// The name of the property for whether to count hardware and software
+  /// events of the client threads, to report per operation.
+  ///
+  static const std::string PERF_PROPERTY;
+  static const std::string PERF_DEFAULT;
+
+  ///
+  /// The name of the property for every how many operations to count the
+  /// events of one operation by itself, which costs two reads of the
+  /// counters, to report events per kind of operation. 0 disables it.
+  ///
+  static const std::string PERF_SAMPLE_PROPERTY;
+  static const std::string PERF_SAMPLE_DEFAULT;
+
+  /// Cumulative counts of a phase at some point of it.
+  struct Sample {
+    double seconds;
+    uint64_t ops;
+    uint64_t oks;
+  };
+
+  ResultWriter(const utils::Properties &p, const std::string &workload);
+
+  bool enabled() const { return !json_file_.empty() || !csv_file_.empty(); }
+  double interval() const { return interval_; }
+  bool count_events() const { return count_events_; }
+  uint64_t sample_events() const { return sample_events_; }
+
+  void Loaded(uint64_t records, double seconds);
+  void AddPhase(const std::string &name, double seconds,
+                const std::vector<ClientStats *> &stats,
+                const std::vector<Sample> &series);
+  /// Writes the files asked for. Throws utils::Exception if it cannot.
+  void Write() const;
+
+  /// Returns the counts of stats so far, as of seconds into the phase.
+  static Sample Tally(const std::vector<ClientStats *> &stats, double seconds);
+
+  ///
+  /// Prints the events per operation of the finished threads of stats,
+  /// if they counted any.
+  ///
+  static void PrintEvents(std::ostream &out,
+                          const std::vector<ClientStats *> &stats);
+
+ private:
+  struct Latency {
+    uint64_t count = 0;
+    uint64_t failed = 0;
+    double mean = 0;  ///< Microseconds, like the percentiles
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+    /// Events per operation, negative where not counted
+    double events[utils::PerfCounters::kNumEvents];
+  };
+
+  struct Phase {
+    std::string name;
+    double seconds;
+    uint64_t ops;
+    uint64_t oks;
+    Latency all;
+    Latency operations[kNumOperations];
+    std::vector<Sample> series;
+  };
+
+  static Latency Summarize(const utils::Histogram &latency, uint64_t failed);
+  ///
+  /// Fills events with the events per operation of stats, of all operations
+  /// if op is kNumOperations, or else of the sampled ones of that kind.
+  /// Leaves -1 for events not counted.
+  ///
+  static void EventsPerOp(const std::vector<ClientStats *> &stats, int op,
+                          double events[utils::PerfCounters::kNumEvents]);
+  static void WriteEventsJson(std::ostream &out, const double *events);
+  void WriteJson(std::ostream &out) const;
+  void WriteCsv(std::ostream &out, bool header) const;
+
+  utils::Properties props_;
+  std::string workload_;
+  std::string json_file_;
+  std::string csv_file_;
+  double interval_;
+  bool count_events_;
+  uint64_t sample_events_;
+  /// Whether operations return once queued, as with redis_async, so that
+  /// their latencies leave out the round trip.
+  bool enqueue_latency_;
+  std::string started_;  ///< UTC time of the run, in ISO 8601
+  uint64_t load_records_;
+  double load_seconds_;
+  std::vector<Phase> phases_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_RESULT_WRITER_H_
@@ -12,12 +12,19 @@
 #include "generator.h"
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include "utils.h"
 #include "zipfian_generator.h"
 
 namespace ycsbc {
 
+///
+/// Spreads the popular items of a zipfian distribution over the key space
+/// by hashing. With a rotation set, the hashed positions are also shifted
+/// by a fixed amount every period, so the hot set moves over time while
+/// keeping its shape.
+///
 class ScrambledZipfianGenerator : public Generator<uint64_t> {
  public:
   ScrambledZipfianGenerator(uint64_t min, uint64_t max,
@@ -30,25 +37,86 @@ class ScrambledZipfianGenerator : public Generator<uint64_t> {
   
   uint64_t Next();
   uint64_t Last();
+  void NextN(uint64_t *out, std::size_t n);
+
+  ///
+  /// Shifts the hot set by shift items every period_ops draws or, if
+  /// period_seconds is positive, every period_seconds from the first draw.
+  /// Must be called before any draw. A zero shift disables rotation.
+  ///
+  void SetRotation(uint64_t shift, uint64_t period_ops, double period_seconds);
   
  private:
+  typedef std::chrono::steady_clock Clock;
+
   const uint64_t base_;
   const uint64_t num_items_;
   ZipfianGenerator generator_;
 
-  uint64_t Scramble(uint64_t value) const;
+  uint64_t shift_ = 0;
+  uint64_t period_ops_ = 0;
+  int64_t period_ns_ = 0;
+  std::atomic<uint64_t> draws_{0};
+  std::atomic<int64_t> start_ns_{0};
+  std::atomic<uint64_t> last_offset_{0};
+
+  /// Returns the current offset, counting n more draws.
+  uint64_t Offset(std::size_t n);
+  uint64_t Scramble(uint64_t value, uint64_t offset) const;
 };
 
-inline uint64_t ScrambledZipfianGenerator::Scramble(uint64_t value) const {
-  return base_ + utils::FNVHash64(value) % num_items_;
+inline void ScrambledZipfianGenerator::SetRotation(uint64_t shift,
+    uint64_t period_ops, double period_seconds) {
+  shift_ = shift % num_items_;
+  period_ops_ = period_ops;
+  period_ns_ = period_seconds * 1e9;
+  if (shift_ && !period_ops_ && period_ns_ <= 0) {
+    throw utils::Exception("Hot set rotation needs a period");
+  }
+}
+
+inline uint64_t ScrambledZipfianGenerator::Offset(std::size_t n) {
+  if (!shift_) return 0;
+  uint64_t epoch;
+  if (period_ns_ > 0) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+    int64_t start = start_ns_.load(std::memory_order_relaxed);
+    // A failed exchange leaves the time of the thread that won in start.
+    if (!start && start_ns_.compare_exchange_strong(start, now)) start = now;
+    epoch = (now - start) / period_ns_;
+  } else {
+    epoch = draws_.fetch_add(n, std::memory_order_relaxed) / period_ops_;
+  }
+  const uint64_t offset = (unsigned __int128)epoch * shift_ % num_items_;
+  last_offset_.store(offset, std::memory_order_relaxed);
+  return offset;
+}
+
+inline uint64_t ScrambledZipfianGenerator::Scramble(uint64_t value,
+                                                    uint64_t offset) const {
+  const uint64_t pos = utils::FNVHash64(value) % num_items_;
+  return base_ + (pos < num_items_ - offset ?
+                  pos + offset : pos - (num_items_ - offset));
 }
 
 inline uint64_t ScrambledZipfianGenerator::Next() {
-  return Scramble(generator_.Next());
+  return Scramble(generator_.Next(), Offset(1));
+}
+
+inline void ScrambledZipfianGenerator::NextN(uint64_t *out, std::size_t n) {
+  // One offset serves the whole batch, so a rotation may land up to a
+  // batch late on each thread.
+  const uint64_t offset = Offset(n);
+  generator_.NextN(out, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = Scramble(out[i], offset);
+  }
 }
 
 inline uint64_t ScrambledZipfianGenerator::Last() {
-  return Scramble(generator_.Last());
+  return Scramble(generator_.Last(),
+                  last_offset_.load(std::memory_order_relaxed));
 }
 
 }
@@ -0,0 +1,45 @@
+//
+//  sequential_generator.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SEQUENTIAL_GENERATOR_H_
+#define YCSB_C_SEQUENTIAL_GENERATOR_H_
+
+#include "generator.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+namespace ycsbc {
+
+///
+/// Walks [min, max] in order and wraps around. Threads share one atomic
+/// counter, so together they visit every item once per pass.
+///
+class SequentialGenerator : public Generator<uint64_t> {
+ public:
+  // Both min and max are inclusive
+  SequentialGenerator(uint64_t min, uint64_t max) :
+      min_(min), items_(max - min + 1), counter_(0) {
+    assert(max >= min);
+  }
+
+  uint64_t Next() { return min_ + counter_.fetch_add(1) % items_; }
+  uint64_t Last() { return min_ + (counter_.load() + items_ - 1) % items_; }
+
+  void NextN(uint64_t *out, std::size_t n) {
+    uint64_t start = counter_.fetch_add(n);
+    for (std::size_t i = 0; i < n; ++i) out[i] = min_ + (start + i) % items_;
+  }
+
+ private:
+  const uint64_t min_;
+  const uint64_t items_;
+  std::atomic<uint64_t> counter_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_SEQUENTIAL_GENERATOR_H_
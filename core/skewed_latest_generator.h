@@ -20,8 +20,9 @@ namespace ycsbc {
 
 class SkewedLatestGenerator : public Generator<uint64_t> {
  public:
-  SkewedLatestGenerator(CounterGenerator &counter) :
-      basis_(counter), zipfian_(basis_.Last()) {
+  SkewedLatestGenerator(CounterGenerator &counter,
+      double zipfian_const = ZipfianGenerator::kZipfianConst) :
+      basis_(counter), zipfian_(0, basis_.Last() - 1, zipfian_const) {
     Next();
   }
   
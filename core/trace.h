@@ -0,0 +1,188 @@
+//
+//  trace.h
+//  YCSB-C
+//
+//  A compact binary format for operation traces, with a writer and an
+//  mmap-based reader.
+//
+
+#ifndef YCSB_C_TRACE_H_
+#define YCSB_C_TRACE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// A trace file starts with the 8-byte magic "YCSBTRC1", followed by
+/// records in issue order. Each record is a TraceRecord header and the key
+/// bytes, zero-padded to a multiple of 8 bytes so that the next header is
+/// aligned. Integers are in host byte order.
+///
+struct TraceRecord {
+  uint64_t timestamp;  ///< Nanoseconds since the trace started, or 0
+  uint32_t value_size; ///< Bytes written, or records for a scan
+  uint16_t key_size;
+  uint8_t op;          ///< An Operation
+  uint8_t reserved;
+
+  std::string_view key() const {
+    return std::string_view(reinterpret_cast<const char *>(this + 1),
+                            key_size);
+  }
+
+  std::size_t size() const { return Size(key_size); }
+
+  static std::size_t Size(std::size_t key_size) {
+    return sizeof(TraceRecord) + (key_size + 7) / 8 * 8;
+  }
+};
+
+const char kTraceMagic[8] = {'Y', 'C', 'S', 'B', 'T', 'R', 'C', '1'};
+
+///
+/// Appends records from any number of threads. Timestamps are taken under
+/// the lock, so they never go backwards in the file.
+///
+class TraceWriter {
+ public:
+  TraceWriter(const std::string &path);
+  ~TraceWriter(); ///< Flushes and closes the file
+
+  void Append(uint8_t op, const std::string &key, uint32_t value_size);
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+  static const std::size_t kBufferSize = 1 << 20;
+
+  void Flush();
+
+  FILE *file_;
+  Clock::time_point start_;
+  std::vector<char> buffer_;
+  std::mutex mutex_;
+};
+
+///
+/// Maps a whole trace into memory. Records are walked in order with
+/// begin(), end() and Next().
+///
+class TraceReader {
+ public:
+  TraceReader(const std::string &path);
+  ~TraceReader();
+
+  const TraceRecord *begin() const {
+    return Cast(data_ + sizeof(kTraceMagic));
+  }
+  const TraceRecord *end() const { return Cast(data_ + size_); }
+  std::size_t num_records() const { return num_records_; }
+
+  static const TraceRecord *Next(const TraceRecord *record) {
+    return Cast(reinterpret_cast<const char *>(record) + record->size());
+  }
+
+ private:
+  static const TraceRecord *Cast(const char *p) {
+    return reinterpret_cast<const TraceRecord *>(p);
+  }
+
+  const char *data_;
+  std::size_t size_;
+  std::size_t num_records_;
+};
+
+//
+// Implementation
+//
+inline TraceWriter::TraceWriter(const std::string &path) :
+    start_(Clock::now()) {
+  file_ = fopen(path.c_str(), "wb");
+  if (!file_) throw utils::Exception("Cannot create trace: " + path);
+  buffer_.reserve(kBufferSize);
+  buffer_.insert(buffer_.end(), kTraceMagic, kTraceMagic + sizeof(kTraceMagic));
+}
+
+inline TraceWriter::~TraceWriter() {
+  Flush();
+  fclose(file_);
+}
+
+inline void TraceWriter::Append(uint8_t op, const std::string &key,
+                                uint32_t value_size) {
+  if (key.size() > UINT16_MAX) throw utils::Exception("Key too long: " + key);
+  TraceRecord record;
+  record.value_size = value_size;
+  record.key_size = key.size();
+  record.op = op;
+  record.reserved = 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now() - start_).count();
+  if (buffer_.size() + TraceRecord::Size(key.size()) > kBufferSize) Flush();
+  const char *header = reinterpret_cast<const char *>(&record);
+  buffer_.insert(buffer_.end(), header, header + sizeof(record));
+  buffer_.insert(buffer_.end(), key.begin(), key.end());
+  buffer_.resize(buffer_.size() + record.size() - sizeof(record) - key.size());
+}
+
+inline void TraceWriter::Flush() {
+  if (fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+    throw utils::Exception("Failed to write trace");
+  }
+  buffer_.clear();
+}
+
+inline TraceReader::TraceReader(const std::string &path) : num_records_(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw utils::Exception("Cannot open trace: " + path);
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(kTraceMagic)) {
+    close(fd);
+    throw utils::Exception("Not a trace: " + path);
+  }
+  size_ = st.st_size;
+  void *p = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) throw utils::Exception("Cannot map trace: " + path);
+  data_ = static_cast<const char *>(p);
+  madvise(p, size_, MADV_SEQUENTIAL);
+
+  if (memcmp(data_, kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    munmap(p, size_);
+    throw utils::Exception("Not a trace: " + path);
+  }
+  // Counts the records, which also checks that none is cut off.
+  const char *last = data_ + size_;
+  const char *r = data_ + sizeof(kTraceMagic);
+  while (r != last) {
+    if ((std::size_t)(last - r) < sizeof(TraceRecord) ||
+        (std::size_t)(last - r) < Cast(r)->size()) {
+      munmap(p, size_);
+      throw utils::Exception("Truncated trace: " + path);
+    }
+    r += Cast(r)->size();
+    ++num_records_;
+  }
+}
+
+inline TraceReader::~TraceReader() {
+  munmap(const_cast<char *>(data_), size_);
+}
+
+} // ycsbc
+
+#endif // YCSB_C_TRACE_H_
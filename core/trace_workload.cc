@@ -0,0 +1,147 @@
+//
+//  trace_workload.cc
+//  YCSB-C
+//
+
+#include "trace_workload.h"
+
+#include <algorithm>
+#include <thread>
+
+using ycsbc::TraceWorkload;
+using ycsbc::TraceRecord;
+using std::string;
+
+const string TraceWorkload::TRACE_FILE_PROPERTY = "trace.file";
+
+const string TraceWorkload::TRACE_MODE_PROPERTY = "trace.mode";
+const string TraceWorkload::TRACE_MODE_DEFAULT = "partitioned";
+
+const string TraceWorkload::TRACE_SPEEDUP_PROPERTY = "trace.speedup";
+const string TraceWorkload::TRACE_SPEEDUP_DEFAULT = "1";
+
+const string TraceWorkload::TRACE_RECORD_PROPERTY = "trace.record";
+
+void TraceWorkload::Init(const utils::Properties &p) {
+  CoreWorkload::Init(p);
+  churn_ = false; // A recorded trace already holds its deletes
+  trace_ = new TraceReader(p.GetProperty(TRACE_FILE_PROPERTY));
+  num_threads_ = std::stoi(p.GetProperty("threadcount", "1"));
+  if (trace_->num_records() < num_threads_) {
+    throw utils::Exception("Trace has fewer records than threads");
+  }
+
+  string mode = p.GetProperty(TRACE_MODE_PROPERTY, TRACE_MODE_DEFAULT);
+  if (mode == "paced") {
+    paced_ = true;
+  } else if (mode != "partitioned") {
+    throw utils::Exception("Unknown trace mode: " + mode);
+  }
+  speedup_ = std::stod(p.GetProperty(TRACE_SPEEDUP_PROPERTY,
+                                     TRACE_SPEEDUP_DEFAULT));
+  if (speedup_ <= 0) throw utils::Exception("trace.speedup must be positive");
+
+  // Splits the trace into contiguous slices of nearly equal record counts,
+  // and finds the longest value to size the value buffer for.
+  uint64_t max_value = 0;
+  const TraceRecord *r = trace_->begin();
+  for (std::size_t i = 0, n = 0; i < num_threads_; ++i) {
+    slices_.push_back(r);
+    const std::size_t end = trace_->num_records() * (i + 1) / num_threads_;
+    for (; n < end; ++n, r = TraceReader::Next(r)) {
+      if (r->op != SCAN) max_value = std::max<uint64_t>(max_value,
+                                                        r->value_size);
+    }
+  }
+  slices_.push_back(r);
+
+  if (max_value <= value_generator_->max_size()) return;
+  delete value_generator_;
+  value_generator_ = new ValueGenerator(std::stod(p.GetProperty(
+      FIELD_COMPRESSION_RATIO_PROPERTY, FIELD_COMPRESSION_RATIO_DEFAULT)),
+      max_value);
+}
+
+TraceWorkload::Cursor &TraceWorkload::LocalCursor() {
+  Cursor &cursor = ThreadCursor();
+  if (cursor.owner == this) return cursor;
+
+  cursor.owner = this;
+  cursor.current = NULL;
+  cursor.index = 0;
+  cursor.thread = next_thread_.fetch_add(1) % num_threads_;
+  if (paced_) {
+    cursor.begin = trace_->begin();
+    cursor.end = trace_->end();
+    std::call_once(started_, [this] { start_ = Clock::now(); });
+  } else {
+    cursor.begin = slices_[cursor.thread];
+    cursor.end = slices_[cursor.thread + 1];
+  }
+  cursor.pos = cursor.begin;
+  return cursor;
+}
+
+const TraceRecord *TraceWorkload::Advance(Cursor &c) const {
+  while (true) {
+    if (c.pos == c.end) {
+      c.pos = c.begin;
+      c.index = 0;
+    }
+    const TraceRecord *record = c.pos;
+    c.pos = TraceReader::Next(c.pos);
+    if (!paced_ || c.index++ % num_threads_ == c.thread) return record;
+  }
+}
+
+ycsbc::Operation TraceWorkload::NextOperation() {
+  Cursor &c = LocalCursor();
+  const TraceRecord *record = Advance(c);
+  if (paced_) {
+    const uint64_t first = trace_->begin()->timestamp;
+    const double offset = (record->timestamp - first) / speedup_;
+    std::this_thread::sleep_until(
+        start_ + std::chrono::nanoseconds((int64_t)offset));
+  }
+  c.current = record;
+  return (Operation)record->op;
+}
+
+string TraceWorkload::NextSequenceKey() {
+  const TraceRecord *record = Current();
+  if (!record) return CoreWorkload::NextSequenceKey(); // Loading
+  return string(record->key());
+}
+
+void TraceWorkload::NextTransactionKeyNums(uint64_t *key_nums, std::size_t n) {
+  std::fill(key_nums, key_nums + n, 0); // Keys come from the trace
+}
+
+string TraceWorkload::TransactionKeyName(uint64_t key_num) {
+  return string(Current()->key());
+}
+
+size_t TraceWorkload::NextScanLength() {
+  return std::max<size_t>(Current()->value_size, 1);
+}
+
+void TraceWorkload::BuildValues(std::vector<ycsbc::DB::KVPair> &values) {
+  const TraceRecord *record = Current();
+  if (!record) return CoreWorkload::BuildValues(values); // Loading
+  // Spreads the recorded bytes over the fields, the first taking the rest.
+  const std::size_t size = record->value_size / field_count_;
+  const std::size_t rest = record->value_size % field_count_;
+  for (int i = 0; i < field_count_; ++i) {
+    ycsbc::DB::KVPair pair;
+    pair.first.append("field").append(std::to_string(i));
+    pair.second.assign(NextValue(size + (i ? 0 : rest)));
+    values.push_back(pair);
+  }
+}
+
+void TraceWorkload::BuildUpdate(std::vector<ycsbc::DB::KVPair> &update) {
+  ycsbc::DB::KVPair pair;
+  pair.first.append(NextFieldName());
+  pair.second.assign(NextValue(Current()->value_size));
+  update.push_back(pair);
+}
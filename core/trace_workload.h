@@ -0,0 +1,116 @@
+//
+//  trace_workload.h
+//  YCSB-C
+//
+//  Replays a recorded trace (see trace.h) in place of generated operations.
+//
+
+#ifndef YCSB_C_TRACE_WORKLOAD_H_
+#define YCSB_C_TRACE_WORKLOAD_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core_workload.h"
+#include "trace.h"
+
+namespace ycsbc {
+
+///
+/// Each client thread replays its own share of the trace: the operation,
+/// key and value size come from the record taken by NextOperation(), while
+/// fields and value bytes are built as in CoreWorkload. A thread that runs
+/// out of records starts its share over. The load phase is unchanged, so
+/// recordcount should match the keys the trace expects to find.
+///
+class TraceWorkload : public CoreWorkload {
+ public:
+  ///
+  /// The name of the property for the trace file to replay.
+  ///
+  static const std::string TRACE_FILE_PROPERTY;
+
+  ///
+  /// The name of the property for how records are dealt to threads.
+  /// Options are "partitioned", where each thread replays a contiguous
+  /// slice as fast as it can, and "paced", where records are dealt round
+  /// robin and each is issued no earlier than its timestamp.
+  ///
+  static const std::string TRACE_MODE_PROPERTY;
+  static const std::string TRACE_MODE_DEFAULT;
+
+  ///
+  /// The name of the property for the factor by which paced replay
+  /// compresses the timestamps of the trace.
+  ///
+  static const std::string TRACE_SPEEDUP_PROPERTY;
+  static const std::string TRACE_SPEEDUP_DEFAULT;
+
+  ///
+  /// The name of the property for a file to which the transactions of any
+  /// workload are recorded, in the format TraceWorkload replays.
+  ///
+  static const std::string TRACE_RECORD_PROPERTY;
+
+  void Init(const utils::Properties &p);
+
+  Operation NextOperation();
+  std::string NextSequenceKey();
+  void NextTransactionKeyNums(uint64_t *key_nums, std::size_t n);
+  std::string TransactionKeyName(uint64_t key_num);
+  std::string ReadKeyName(uint64_t key_num) { return TransactionKeyName(0); }
+  std::string NextDeleteKey() { return TransactionKeyName(0); }
+  size_t NextScanLength();
+  void BuildValues(std::vector<ycsbc::DB::KVPair> &values);
+  void BuildUpdate(std::vector<ycsbc::DB::KVPair> &update);
+
+  std::size_t num_records() const { return trace_->num_records(); }
+
+  TraceWorkload() : trace_(NULL), paced_(false), speedup_(1),
+      num_threads_(1), next_thread_(0) { }
+  ~TraceWorkload() { delete trace_; }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  ///
+  /// Per-thread replay position. The owner check makes a thread that
+  /// moves on to another workload start afresh.
+  ///
+  struct Cursor {
+    const TraceWorkload *owner = NULL;
+    const TraceRecord *begin, *end, *pos;
+    const TraceRecord *current = NULL; ///< The operation being issued
+    std::size_t index, thread;         ///< For paced, round-robin dealing
+  };
+
+  static Cursor &ThreadCursor() {
+    static thread_local Cursor cursor;
+    return cursor;
+  }
+
+  /// Returns the cursor of this thread, claiming a share on first use.
+  Cursor &LocalCursor();
+  const TraceRecord *Advance(Cursor &c) const;
+
+  /// Returns the record being issued, or NULL outside of NextOperation().
+  const TraceRecord *Current() const {
+    const Cursor &c = ThreadCursor();
+    return c.owner == this ? c.current : NULL;
+  }
+
+  TraceReader *trace_;
+  std::vector<const TraceRecord *> slices_; ///< Thread i gets [i, i + 1)
+  bool paced_;
+  double speedup_;
+  std::size_t num_threads_;
+  std::atomic<std::size_t> next_thread_;
+  std::once_flag started_;
+  Clock::time_point start_; ///< When paced replay issued its first record
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TRACE_WORKLOAD_H_
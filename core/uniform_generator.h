@@ -12,34 +12,52 @@
 #include "generator.h"
 
 #include <atomic>
-#include <mutex>
-#include <random>
+#include <cassert>
+#include "utils.h"
 
 namespace ycsbc {
 
+///
+/// Draws from the calling thread's own random stream, so neither Next nor
+/// NextN takes a lock.
+///
 class UniformGenerator : public Generator<uint64_t> {
  public:
   // Both min and max are inclusive
-  UniformGenerator(uint64_t min, uint64_t max) : dist_(min, max) { Next(); }
+  UniformGenerator(uint64_t min, uint64_t max) :
+      min_(min), range_(max - min + 1) {
+    assert(max >= min && range_ != 0);
+    Next();
+  }
   
   uint64_t Next();
-  uint64_t Last();
+  uint64_t Last() { return last_int_.load(std::memory_order_relaxed); }
+  void NextN(uint64_t *out, std::size_t n);
   
  private:
-  std::mt19937_64 generator_;
-  std::uniform_int_distribution<uint64_t> dist_;
-  uint64_t last_int_;
-  std::mutex mutex_;
+  /// Maps 64 random bits into [min_, min_ + range_) by a multiply-shift.
+  uint64_t Scale(uint64_t bits) const {
+    return min_ + (uint64_t)(((unsigned __int128)bits * range_) >> 64);
+  }
+
+  const uint64_t min_;
+  const uint64_t range_;
+  std::atomic<uint64_t> last_int_;
 };
 
 inline uint64_t UniformGenerator::Next() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return last_int_ = dist_(generator_);
+  uint64_t value = Scale(utils::ThreadLocalRandom64());
+  last_int_.store(value, std::memory_order_relaxed);
+  return value;
 }
 
-inline uint64_t UniformGenerator::Last() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return last_int_;
+inline void UniformGenerator::NextN(uint64_t *out, std::size_t n) {
+  if (n == 0) return;
+  utils::ThreadLocalRandom64N(out, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = Scale(out[i]);
+  }
+  last_int_.store(out[n - 1], std::memory_order_relaxed);
 }
 
 } // ycsbc
@@ -10,6 +10,7 @@
 #define YCSB_C_UTILS_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <exception>
 #include <random>
@@ -34,6 +35,46 @@ inline uint64_t FNVHash64(uint64_t val) {
 
 inline uint64_t Hash(uint64_t val) { return FNVHash64(val); }
 
+const uint64_t kSplitMixGamma = 0x9E3779B97F4A7C15;
+
+inline uint64_t SplitMix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t &ThreadLocalRandomState() {
+  static std::atomic<uint64_t> seeds(kSplitMixGamma);
+  static thread_local uint64_t state = seeds.fetch_add(kSplitMixGamma);
+  return state;
+}
+
+///
+/// Returns 64 random bits from a generator private to the calling thread,
+/// so callers need no lock.
+///
+inline uint64_t ThreadLocalRandom64() {
+  return SplitMix64(ThreadLocalRandomState() += kSplitMixGamma);
+}
+
+///
+/// Fills out with the next n values of ThreadLocalRandom64(). Each value
+/// depends only on its index, so the loop vectorizes.
+///
+inline void ThreadLocalRandom64N(uint64_t *out, std::size_t n) {
+  uint64_t &state = ThreadLocalRandomState();
+  const uint64_t base = state;
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = SplitMix64(base + (i + 1) * kSplitMixGamma);
+  }
+  state = base + n * kSplitMixGamma;
+}
+
+/// Maps 64 random bits to a double in [0, 1).
+inline double ToUnitDouble(uint64_t bits) {
+  return (bits >> 11) * 0x1.0p-53;
+}
+
 inline double RandomDouble(double min = 0.0, double max = 1.0) {
   static std::default_random_engine generator;
   static std::uniform_real_distribution<double> uniform(min, max);
@@ -0,0 +1,85 @@
+//
+//  value_generator.h
+//  YCSB-C
+//
+//  Slices field values out of a shared buffer with a given compressibility.
+//
+
+#ifndef YCSB_C_VALUE_GENERATOR_H_
+#define YCSB_C_VALUE_GENERATOR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "utils.h"
+
+namespace ycsbc {
+
+///
+/// The buffer is generated once, so building a value costs one copy
+/// instead of a random draw per byte. Like the compressible strings of
+/// RocksDB's db_bench, it is made of blocks that each repeat a random
+/// fragment 1 / compression_ratio of the block long. An LZ-style
+/// compressor such as Snappy then shrinks any value spanning a few blocks
+/// by about compression_ratio; a ratio of 1 gives incompressible values.
+///
+class ValueGenerator {
+ public:
+  ///
+  /// @param compression_ratio Target uncompressed to compressed size, >= 1.
+  /// @param max_size The longest value that will be asked for.
+  ///
+  ValueGenerator(double compression_ratio, std::size_t max_size);
+
+  ///
+  /// Returns size bytes starting at a random offset in the buffer, valid
+  /// for the lifetime of the generator.
+  ///
+  std::string_view Next(std::size_t size) const;
+
+  std::size_t max_size() const { return buffer_.size(); }
+
+ private:
+  static const std::size_t kBlockSize = 128;
+  static const std::size_t kMinBufferSize = 1 << 20;
+
+  std::string buffer_;
+};
+
+inline ValueGenerator::ValueGenerator(double compression_ratio,
+                                      std::size_t max_size) {
+  if (compression_ratio < 1) {
+    throw utils::Exception("Compression ratio must be at least 1");
+  }
+  const std::size_t size = std::max(kMinBufferSize, 2 * max_size);
+  const std::size_t fragment = std::max<std::size_t>(
+      kBlockSize / compression_ratio, 1);
+  buffer_.resize(size);
+  uint64_t seed = 0;
+  for (std::size_t block = 0; block < size; block += kBlockSize) {
+    const std::size_t end = std::min(block + kBlockSize, size);
+    for (std::size_t i = block; i < end; ++i) {
+      if (i - block < fragment) {
+        seed += utils::kSplitMixGamma;
+        buffer_[i] = utils::SplitMix64(seed) % 94 + 33; // Printable
+      } else {
+        buffer_[i] = buffer_[i - fragment];
+      }
+    }
+  }
+}
+
+inline std::string_view ValueGenerator::Next(std::size_t size) const {
+  if (size > buffer_.size()) {
+    throw utils::Exception("Value longer than the value buffer");
+  }
+  const uint64_t range = buffer_.size() - size + 1;
+  const uint64_t offset = (unsigned __int128)utils::ThreadLocalRandom64() *
+      range >> 64;
+  return std::string_view(buffer_.data() + offset, size);
+}
+
+} // ycsbc
+
+#endif // YCSB_C_VALUE_GENERATOR_H_
@@ -13,6 +13,7 @@
 #include <cmath>
 #include <cstdint>
 #include <mutex>
+#include "generator.h"
 #include "utils.h"
 
 namespace ycsbc {
@@ -29,6 +30,7 @@ class ZipfianGenerator : public Generator<uint64_t> {
     assert(num_items_ >= 2 && num_items_ < kMaxNumItems);
     zeta_2_ = Zeta(2, theta_);
     alpha_ = 1.0 / (1.0 - theta_);
+    half_pow_theta_ = std::pow(0.5, theta_);
     RaiseZeta(num_items_);
     eta_ = Eta();
     
@@ -43,6 +45,11 @@ class ZipfianGenerator : public Generator<uint64_t> {
   uint64_t Next() { return Next(num_items_); }
 
   uint64_t Last();
+
+  ///
+  /// Draws n values over the initial item count, taking the lock once.
+  ///
+  void NextN(uint64_t *out, std::size_t n);
   
  private:
   ///
@@ -78,12 +85,20 @@ class ZipfianGenerator : public Generator<uint64_t> {
   static double Zeta(uint64_t num, double theta) {
     return Zeta(0, num, theta, 0);
   }
+
+  /// Maps a uniform u in [0, 1) to an item among the first num.
+  uint64_t Draw(double u, uint64_t num) const {
+    const double uz = u * zeta_n_;
+    if (uz < 1.0) return base_;
+    if (uz < 1.0 + half_pow_theta_) return base_ + 1;
+    return base_ + num * std::pow(eta_ * u - eta_ + 1, alpha_);
+  }
   
   uint64_t num_items_;
   uint64_t base_; /// Min number of items to generate
   
   // Computed parameters for generating the distribution
-  double theta_, zeta_n_, eta_, alpha_, zeta_2_;
+  double theta_, zeta_n_, eta_, alpha_, zeta_2_, half_pow_theta_;
   uint64_t n_for_zeta_; /// Number of items used to compute zeta_n
   uint64_t last_value_;
   std::mutex mutex_;
@@ -98,18 +113,24 @@ inline uint64_t ZipfianGenerator::Next(uint64_t num) {
     eta_ = Eta();
   }
   
-  double u = utils::RandomDouble();
-  double uz = u * zeta_n_;
-  
-  if (uz < 1.0) {
-    return last_value_ = 0;
+  return last_value_ = Draw(utils::ToUnitDouble(utils::ThreadLocalRandom64()),
+                            num);
+}
+
+inline void ZipfianGenerator::NextN(uint64_t *out, std::size_t n) {
+  if (n == 0) return;
+  // Random bits are drawn outside the lock, and then turned into items in
+  // place in a loop without calls or cross-iteration dependencies.
+  utils::ThreadLocalRandom64N(out, n);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_items_ > n_for_zeta_) {
+    RaiseZeta(num_items_);
+    eta_ = Eta();
   }
-  
-  if (uz < 1.0 + std::pow(0.5, theta_)) {
-    return last_value_ = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = Draw(utils::ToUnitDouble(out[i]), num_items_);
   }
-
-  return last_value_ = base_ + num * std::pow(eta_ * u - eta_ + 1, alpha_);
+  last_value_ = out[n - 1];
 }
 
 inline uint64_t ZipfianGenerator::Last() {
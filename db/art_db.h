@@ -0,0 +1,27 @@
+//
+//  art_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_ART_DB_H_
+#define YCSB_C_ART_DB_H_
+
+#include "db/lock_free_db.h"
+
+#include "lib/art_hashtable.h"
+
+namespace ycsbc {
+
+///
+/// Indexes records with an adaptive radix tree, which compresses the long
+/// shared prefixes of YCSB keys and returns scans in key order.
+///
+class ArtDB : public LockFreeDB {
+ public:
+  ArtDB() : LockFreeDB(
+      new vmp::ArtHashtable<vmp::FlatRecord *, SlabAlloc>) { }
+};
+
+} // ycsbc
+
+#endif // YCSB_C_ART_DB_H_
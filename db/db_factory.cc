@@ -11,24 +11,53 @@
 #include <string>
 #include "db/basic_db.h"
 #include "db/lock_stl_db.h"
+#include "db/striped_stl_db.h"
+#include "db/lock_free_db.h"
+#include "db/skiplist_db.h"
+#include "db/art_db.h"
 #include "db/redis_db.h"
+#include "db/redis_async_db.h"
 #include "db/tbb_rand_db.h"
 #include "db/tbb_scan_db.h"
 #include "db/rocksdb_db.h"
+#include "lib/slab_alloc.h"
 
 using namespace std;
 using ycsbc::DB;
 using ycsbc::DBFactory;
 
 DB* DBFactory::CreateDB(utils::Properties &props) {
+  // Must precede any allocation by the in-memory engines.
+  if (!SlabAlloc::Configure(
+      props.GetProperty("slab.enabled", "true") == "true",
+      props.GetProperty("slab.hugepages", "false") == "true")) {
+    throw utils::Exception("slab.enabled cannot change while records of "
+                           "another DB are live");
+  }
+
   if (props["dbname"] == "basic") {
     return new BasicDB;
   } else if (props["dbname"] == "lock_stl") {
     return new LockStlDB;
+  } else if (props["dbname"] == "striped_stl") {
+    return new StripedStlDB(stoi(props.GetProperty("striped_stl.shards", "64")));
+  } else if (props["dbname"] == "lock_free") {
+    // The table does not grow; ycsbc sizes it for the run unless given.
+    const string capacity = props.GetProperty("lock_free.capacity");
+    if (capacity.empty()) {
+      throw utils::Exception("lock_free needs lock_free.capacity");
+    }
+    return new LockFreeDB(stoull(capacity));
+  } else if (props["dbname"] == "skiplist") {
+    return new SkiplistDB;
+  } else if (props["dbname"] == "art") {
+    return new ArtDB;
   } else if (props["dbname"] == "redis") {
     int port = stoi(props["port"]);
     int slaves = stoi(props["slaves"]);
     return new RedisDB(props["host"].c_str(), port, slaves);
+  } else if (props["dbname"] == "redis_async") {
+    return new RedisAsyncDB(props);
   } else if (props["dbname"] == "tbb_rand") {
     return new TbbRandDB;
   } else if (props["dbname"] == "tbb_scan") {
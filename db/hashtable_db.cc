@@ -8,63 +8,73 @@
 
 #include "db/hashtable_db.h"
 
+#include <cstring>
 #include <string>
 #include <vector>
+#include "lib/epoch.h"
+#include "lib/flat_record.h"
 #include "lib/string_hashtable.h"
 
 using std::string;
 using std::vector;
-using vmp::StringHashtable;
+using vmp::FlatRecord;
+using vmp::String;
 
 namespace ycsbc {
 
-int HashtableDB::Read(const string &table, const string &key,
-    const vector<string> *fields, vector<KVPair> &result) {
-  string key_index(table + key);
-  FieldHashtable *field_table = key_table_->Get(key_index.c_str());
-  if (!field_table) return DB::kErrorNoData;
+HashtableDB::~HashtableDB() {
+  vector<KeyHashtable::KVPair> key_pairs = key_table_->Entries();
+  for (auto &key_pair : key_pairs) {
+    FlatRecord::Free<SlabAlloc>(key_pair.second);
+  }
+  delete key_table_;
+}
 
-  result.clear();
+void HashtableDB::RetireRecord(FlatRecord *record) {
+  vmp::Epoch::Retire(record, [](void *p) {
+    FlatRecord::Free<SlabAlloc>(static_cast<FlatRecord *>(p));
+  });
+}
+
+void HashtableDB::ReadFields(const FlatRecord &record,
+    const vector<string> *fields, vector<KVPair> &result) {
   if (!fields) {
-    vector<FieldHashtable::KVPair> field_pairs = field_table->Entries();
-    for (auto &field_pair : field_pairs) {
-      result.push_back(std::make_pair(field_pair.first, field_pair.second));
+    for (size_t i = 0; i < record.num_fields(); ++i) {
+      result.emplace_back(string(record.name(i)), string(record.value(i)));
     }
   } else {
     for (auto &field : *fields) {
-      const char *value = field_table->Get(field.c_str());
-      if (!value) continue;
-      result.push_back(std::make_pair(field, value));
+      int i = record.Find(field);
+      if (i < 0) continue;
+      result.emplace_back(field, string(record.value(i)));
     }
   }
+}
+
+int HashtableDB::Read(const string &table, const string &key,
+    const vector<string> *fields, vector<KVPair> &result) {
+  vmp::Epoch::Guard guard;
+  string key_index(table + key);
+  const String skey = String::Wrap(key_index.c_str(), key_index.size());
+  FlatRecord *record = key_table_->Get(skey);
+  if (!record) return DB::kErrorNoData;
+
+  result.clear();
+  ReadFields(*record, fields, result);
   return DB::kOK;
 }
 
 int HashtableDB::Scan(const string &table, const string &key, int len,
     const vector<string> *fields, vector<vector<KVPair>> &result) {
+  vmp::Epoch::Guard guard;
   string key_index(table + key);
-  vector<KeyHashtable::KVPair> key_pairs =
-      key_table_->Entries(key_index.c_str(), len);
+  const String skey = String::Wrap(key_index.c_str(), key_index.size());
+  vector<KeyHashtable::KVPair> key_pairs = key_table_->Entries(&skey, len);
 
   result.clear();
   for (auto &key_pair : key_pairs) {
-    FieldHashtable *field_table = key_pair.second;
-
     vector<KVPair> field_values;
-    if (!fields) {
-      vector<FieldHashtable::KVPair> field_pairs = field_table->Entries();
-      for (auto &field_pair : field_pairs) {
-        field_values.push_back(
-            std::make_pair(field_pair.first, field_pair.second));
-      }
-    } else {
-      for (auto &field : *fields) {
-        const char *value = field_table->Get(field.c_str());
-        if (!value) continue;
-        field_values.push_back(std::make_pair(field, value));
-      }
-    }
-
+    ReadFields(*key_pair.second, fields, field_values);
     result.push_back(field_values);
   }
   return DB::kOK;
@@ -72,58 +82,68 @@ int HashtableDB::Scan(const string &table, const string &key, int len,
 
 int HashtableDB::Update(const string &table, const string &key,
     vector<KVPair> &values) {
+  vmp::Epoch::Guard guard;
   string key_index(table + key);
-  FieldHashtable *field_table = key_table_->Get(key_index.c_str());
-  if (!field_table) {
-    field_table = NewFieldHashtable();
-    key_table_->Insert(key_index.c_str(), field_table);
-    for (KVPair &field_pair : values) {
-      const char *value = CopyString(field_pair.second);
-      field_table->Insert(field_pair.first.c_str(), value);
+  const String skey = String::Wrap(key_index.c_str(), key_index.size());
+  FlatRecord *record = key_table_->Get(skey);
+  while (true) {
+    if (!record) {
+      FlatRecord *fresh = NewRecord(values);
+      if (key_table_->Insert(skey, fresh)) return DB::kOK;
+      FlatRecord::Free<SlabAlloc>(fresh); // Never published
+      // Merges into the record another thread inserted in the meantime.
+      record = key_table_->Get(skey);
+      if (!record) return DB::kErrorConflict;
     }
-  } else {
-    for (KVPair &field_pair : values) {
-      const char *value = CopyString(field_pair.second);
-      const char *old = field_table->Update(field_pair.first.c_str(), value);
-      if (!old) {
-        field_table->Insert(field_pair.first.c_str(), value);
-      } else {
-        DeleteString(old);
-      }
+    // The guard keeps record from being freed, and so its address from
+    // being reused, until the swap below has compared against it.
+    FlatRecord *merged = FlatRecord::Merge<SlabAlloc>(*record, values);
+    if (key_table_->Replace(skey, record, merged)) {
+      RetireRecord(record);
+      return DB::kOK;
     }
+    FlatRecord::Free<SlabAlloc>(merged);
+    record = key_table_->Get(skey);
   }
-  return DB::kOK;
 }
 
 int HashtableDB::Insert(const string &table, const string &key,
     vector<KVPair> &values) {
+  vmp::Epoch::Guard guard;
   string key_index(table + key);
-  FieldHashtable *field_table = key_table_->Get(key_index.c_str());
-  if (!field_table) {
-    field_table = NewFieldHashtable();
-    key_table_->Insert(key_index.c_str(), field_table);
-  }
-
-  for (KVPair &field_pair : values) {
-    const char *value = CopyString(field_pair.second);
-    bool ok = field_table->Insert(field_pair.first.c_str(), value);
-    if (!ok) {
-      DeleteString(value);
-      return DB::kErrorConflict;
-    }
+  const String skey = String::Wrap(key_index.c_str(), key_index.size());
+  FlatRecord *record = NewRecord(values);
+  if (!key_table_->Insert(skey, record)) {
+    RetireRecord(record);
+    return DB::kErrorConflict;
   }
   return DB::kOK;
 }
 
 int HashtableDB::Delete(const string &table, const string &key) {
+  vmp::Epoch::Guard guard;
   string key_index(table + key);
-  FieldHashtable *field_table = key_table_->Remove(key_index.c_str());
-  if (!field_table) {
+  const String skey = String::Wrap(key_index.c_str(), key_index.size());
+  FlatRecord *record = key_table_->Remove(skey);
+  if (!record) {
     return DB::kErrorNoData;
   } else {
-    DeleteFieldHashtable(field_table);
+    RetireRecord(record);
   }
   return DB::kOK;
 }
 
+uint64_t HashtableDB::MemoryUsage() {
+  vmp::Epoch::Guard guard;
+  // The slab allocator also counts rounding, so prefer it when in use.
+  if (SlabAlloc::enabled()) return SlabAlloc::GetStats().bytes;
+
+  uint64_t bytes = 0;
+  vector<KeyHashtable::KVPair> key_pairs = key_table_->Entries();
+  for (auto &key_pair : key_pairs) {
+    bytes += key_pair.first.length() + 1 + key_pair.second->size();
+  }
+  return bytes;
+}
+
 } // ycsbc
@@ -13,14 +13,25 @@
 
 #include <string>
 #include <vector>
+#include "lib/flat_record.h"
+#include "lib/slab_alloc.h"
 #include "lib/string_hashtable.h"
 
 namespace ycsbc {
 
+///
+/// Maps each key to a vmp::FlatRecord holding all of its fields in one
+/// allocation. Records are never modified once published: updates swap in
+/// a merged copy by Replace, and merge again from the current record when
+/// another writer got there first, so concurrent updates of different
+/// fields all survive. Every operation runs inside a vmp::Epoch guard and
+/// replaced or removed records are retired, so readers need no lock to
+/// keep a record alive while copying it out. Records and keys come from
+/// SlabAlloc.
+///
 class HashtableDB : public DB {
  public:
-  typedef vmp::StringHashtable<const char *> FieldHashtable;
-  typedef vmp::StringHashtable<FieldHashtable *> KeyHashtable;
+  typedef vmp::StringHashtable<vmp::FlatRecord *> KeyHashtable;
 
   int Read(const std::string &table, const std::string &key,
            const std::vector<std::string> *fields,
@@ -34,16 +45,27 @@ class HashtableDB : public DB {
              std::vector<KVPair> &values);
   int Delete(const std::string &table, const std::string &key);
 
+  ///
+  /// Counts keys and records, excluding the index structure itself.
+  ///
+  uint64_t MemoryUsage();
+
+  virtual ~HashtableDB();
+
  protected:
   HashtableDB(KeyHashtable *table) : key_table_(table) { }
 
-  virtual FieldHashtable *NewFieldHashtable() = 0;
-  virtual void DeleteFieldHashtable(FieldHashtable *table) = 0;
-
-  virtual const char *CopyString(const std::string &str) = 0;
-  virtual void DeleteString(const char *str) = 0;
+  vmp::FlatRecord *NewRecord(const std::vector<KVPair> &values) {
+    return vmp::FlatRecord::New<SlabAlloc>(values);
+  }
 
   KeyHashtable *key_table_;
+
+ private:
+  static void RetireRecord(vmp::FlatRecord *record);
+  static void ReadFields(const vmp::FlatRecord &record,
+                         const std::vector<std::string> *fields,
+                         std::vector<KVPair> &result);
 };
 
 } // ycsbc
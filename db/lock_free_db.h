@@ -0,0 +1,68 @@
+//
+//  lock_free_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_LOCK_FREE_DB_H_
+#define YCSB_C_LOCK_FREE_DB_H_
+
+#include "db/hashtable_db.h"
+
+#include <atomic>
+#include <iostream>
+#include "lib/lock_free_hashtable.h"
+
+namespace ycsbc {
+
+///
+/// The key table is lock-free, so together with the epoch reclamation in
+/// HashtableDB no operation takes a lock.
+///
+class LockFreeDB : public HashtableDB {
+ public:
+  typedef vmp::LockFreeHashtable<vmp::FlatRecord *, SlabAlloc> FixedTable;
+
+  ///
+  /// @param capacity Slots in the key table; must exceed the number of
+  ///        distinct keys ever inserted, as the table does not grow. The
+  ///        first insert that finds it full is reported on stderr.
+  ///
+  LockFreeDB(std::size_t capacity) : LockFreeDB(new FixedTable(capacity)) { }
+
+  int Update(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    return CheckFull(HashtableDB::Update(table, key, values));
+  }
+
+  int Insert(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    return CheckFull(HashtableDB::Insert(table, key, values));
+  }
+
+ protected:
+  ///
+  /// For engines that only swap in another lock-free key table.
+  ///
+  LockFreeDB(KeyHashtable *table) : HashtableDB(table), fixed_(NULL),
+      full_reported_(false) { }
+
+ private:
+  LockFreeDB(FixedTable *table) : HashtableDB(table), fixed_(table),
+      full_reported_(false) { }
+
+  int CheckFull(int status) {
+    if (status == kErrorConflict && fixed_ && fixed_->full() &&
+        !full_reported_.exchange(true)) {
+      std::cerr << "lock_free: the key table is full, so inserts of new keys "
+                   "fail; raise lock_free.capacity" << std::endl;
+    }
+    return status;
+  }
+
+  FixedTable *fixed_; ///< The fixed-capacity table, if this engine uses it
+  std::atomic<bool> full_reported_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_LOCK_FREE_DB_H_
@@ -0,0 +1,77 @@
+//
+//  recording_db.h
+//  YCSB-C
+//
+//  Forwards every operation to another DB and records it to a trace.
+//
+
+#ifndef YCSB_C_RECORDING_DB_H_
+#define YCSB_C_RECORDING_DB_H_
+
+#include "core/db.h"
+
+#include <string>
+#include "core/core_workload.h"
+#include "core/trace.h"
+
+namespace ycsbc {
+
+///
+/// Reads are recorded with a zero value size, scans with their record
+/// count, and writes with the total bytes of their values. The trace is
+/// complete once the RecordingDB is deleted.
+///
+class RecordingDB : public DB {
+ public:
+  RecordingDB(DB &db, const std::string &path) : db_(db), writer_(path) { }
+
+  void Init() { db_.Init(); }
+  void Close() { db_.Close(); }
+
+  int Read(const std::string &table, const std::string &key,
+           const std::vector<std::string> *fields,
+           std::vector<KVPair> &result) {
+    writer_.Append(READ, key, 0);
+    return db_.Read(table, key, fields, result);
+  }
+
+  int Scan(const std::string &table, const std::string &key,
+           int len, const std::vector<std::string> *fields,
+           std::vector<std::vector<KVPair>> &result) {
+    writer_.Append(SCAN, key, len);
+    return db_.Scan(table, key, len, fields, result);
+  }
+
+  int Update(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    writer_.Append(UPDATE, key, ValueSize(values));
+    return db_.Update(table, key, values);
+  }
+
+  int Insert(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    writer_.Append(INSERT, key, ValueSize(values));
+    return db_.Insert(table, key, values);
+  }
+
+  int Delete(const std::string &table, const std::string &key) {
+    writer_.Append(DELETE, key, 0);
+    return db_.Delete(table, key);
+  }
+
+  uint64_t MemoryUsage() { return db_.MemoryUsage(); }
+
+ private:
+  static uint32_t ValueSize(const std::vector<KVPair> &values) {
+    uint32_t size = 0;
+    for (const KVPair &pair : values) size += pair.second.size();
+    return size;
+  }
+
+  DB &db_;
+  TraceWriter writer_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_RECORDING_DB_H_
@@ -0,0 +1,85 @@
+//
+//  redis_async_db.cc
+//  YCSB-C
+//
+
+#include "redis_async_db.h"
+
+#include <cstring>
+
+using namespace std;
+
+namespace ycsbc {
+
+const string RedisAsyncDB::kPropertyConnections = "redis.connections";
+const string RedisAsyncDB::kPropertyInflight = "redis.inflight";
+
+thread_local RedisAsyncClient *RedisAsyncDB::redis_ = nullptr;
+
+RedisAsyncDB::RedisAsyncDB(utils::Properties &props) :
+    host_(props["host"]), port_(stoi(props["port"])),
+    slaves_(stoi(props.GetProperty("slaves", "0"))),
+    num_conns_(stoi(props.GetProperty(kPropertyConnections, "1"))),
+    inflight_(stoi(props.GetProperty(kPropertyInflight, "32"))) {
+}
+
+void RedisAsyncDB::Init() {
+  assert(!redis_);
+  redis_ = new RedisAsyncClient(host_.c_str(), port_, slaves_,
+                                num_conns_, inflight_);
+}
+
+void RedisAsyncDB::Close() {
+  if (!redis_) return;
+  redis_->Drain();
+  if (redis_->errors()) {
+    cerr << "Redis replied with " << redis_->errors() << " errors" << endl;
+  }
+  delete redis_;
+  redis_ = nullptr;
+}
+
+int RedisAsyncDB::Read(const string &table, const string &key,
+         const vector<string> *fields,
+         vector<KVPair> &result) {
+  int argc = fields ? fields->size() + 2 : 2;
+  const char *argv[argc];
+  size_t argvlen[argc];
+  int i = 0;
+  argv[i] = fields ? "HMGET" : "HGETALL"; argvlen[i] = strlen(argv[i]);
+  argv[++i] = key.data(); argvlen[i] = key.size();
+  if (fields) {
+    for (const string &f : *fields) {
+      argv[++i] = f.data(); argvlen[i] = f.size();
+    }
+  }
+  assert(i == argc - 1);
+  redis_->Command(argc, argv, argvlen, false);
+  return DB::kOK;
+}
+
+int RedisAsyncDB::Update(const string &table, const string &key,
+           vector<KVPair> &values) {
+  int argc = values.size() * 2 + 2;
+  const char *argv[argc];
+  size_t argvlen[argc];
+  int i = 0;
+  argv[i] = "HMSET"; argvlen[i] = strlen(argv[i]);
+  argv[++i] = key.data(); argvlen[i] = key.size();
+  for (KVPair &p : values) {
+    argv[++i] = p.first.data(); argvlen[i] = p.first.size();
+    argv[++i] = p.second.data(); argvlen[i] = p.second.size();
+  }
+  assert(i == argc - 1);
+  redis_->Command(argc, argv, argvlen, true);
+  return DB::kOK;
+}
+
+int RedisAsyncDB::Delete(const string &table, const string &key) {
+  const char *argv[2] = { "DEL", key.data() };
+  size_t argvlen[2] = { 3, key.size() };
+  redis_->Command(2, argv, argvlen, true);
+  return DB::kOK;
+}
+
+} // namespace ycsbc
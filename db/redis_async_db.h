@@ -0,0 +1,67 @@
+//
+//  redis_async_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_REDIS_ASYNC_DB_H_
+#define YCSB_C_REDIS_ASYNC_DB_H_
+
+#include "core/db.h"
+
+#include <string>
+#include <vector>
+#include "core/properties.h"
+#include "redis/redis_async_client.h"
+
+namespace ycsbc {
+
+///
+/// Redis driver that pipelines requests through hiredis async contexts.
+/// Each client thread owns an epoll loop and its own connections, so a few
+/// threads can keep many requests in flight. Operations return as soon as
+/// they are queued; replies are consumed by the loop and not copied back,
+/// so Read leaves the result empty.
+///
+class RedisAsyncDB : public DB {
+ public:
+  RedisAsyncDB(utils::Properties &props);
+
+  void Init();
+  void Close();
+
+  int Read(const std::string &table, const std::string &key,
+           const std::vector<std::string> *fields,
+           std::vector<KVPair> &result);
+
+  int Scan(const std::string &table, const std::string &key,
+           int len, const std::vector<std::string> *fields,
+           std::vector<std::vector<KVPair>> &result) {
+    throw "Scan: function not implemented!";
+  }
+
+  int Update(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values);
+
+  int Insert(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    return Update(table, key, values);
+  }
+
+  int Delete(const std::string &table, const std::string &key);
+
+ private:
+  static const std::string kPropertyConnections;
+  static const std::string kPropertyInflight;
+
+  std::string host_;
+  int port_;
+  int slaves_;
+  int num_conns_; ///< Connections per client thread
+  int inflight_; ///< Max outstanding requests per connection
+
+  static thread_local RedisAsyncClient *redis_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_REDIS_ASYNC_DB_H_
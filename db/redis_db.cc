@@ -37,13 +37,14 @@ int RedisDB::Read(const string &table, const string &key,
     freeReplyObject(reply);
   } else {
     redisReply *reply = (redisReply *)redisCommand(redis_.context(),
-        "HGETALL %s", key.c_str());
+        "HGETALL %b", key.data(), key.size());
     if (!reply) return DB::kOK;
     assert(reply->type == REDIS_REPLY_ARRAY);
     for (size_t i = 0; i < reply->elements / 2; ++i) {
       result.push_back(make_pair(
-          string(reply->element[2 * i]->str),
-          string(reply->element[2 * i + 1]->str)));
+          string(reply->element[2 * i]->str, reply->element[2 * i]->len),
+          string(reply->element[2 * i + 1]->str,
+                 reply->element[2 * i + 1]->len)));
     }
     freeReplyObject(reply);
   }
@@ -52,23 +53,32 @@ int RedisDB::Read(const string &table, const string &key,
 
 int RedisDB::Update(const string &table, const string &key,
            vector<KVPair> &values) {
-  string cmd("HMSET");
-  size_t len = cmd.length() + key.length() + 1;
+  int argc = values.size() * 2 + 2;
+  const char *argv[argc];
+  size_t argvlen[argc];
+  int i = 0;
+  argv[i] = "HMSET"; argvlen[i] = strlen(argv[i]);
+  argv[++i] = key.data(); argvlen[i] = key.size();
   for (KVPair &p : values) {
-    len += p.first.length() + p.second.length() + 2;
+    argv[++i] = p.first.data(); argvlen[i] = p.first.size();
+    argv[++i] = p.second.data(); argvlen[i] = p.second.size();
   }
-  cmd.reserve(len);
+  assert(i == argc - 1);
+  redis_.Command(argc, argv, argvlen);
+  return DB::kOK;
+}
 
-  cmd.append(" ").append(key);
-  for (KVPair &p : values) {
-    assert(p.first.find(' ') == string::npos);
-    cmd.append(" ").append(p.first);
-    assert(p.second.find(' ') == string::npos);
-    cmd.append(" ").append(p.second);
+uint64_t RedisDB::MemoryUsage() {
+  redisReply *reply = (redisReply *)redisCommand(redis_.context(),
+      "INFO memory");
+  if (!reply) return 0;
+  uint64_t bytes = 0;
+  if (reply->type == REDIS_REPLY_STRING) {
+    const char *field = strstr(reply->str, "used_memory:");
+    if (field) bytes = strtoull(field + strlen("used_memory:"), NULL, 10);
   }
-  assert(cmd.length() == len);
-  redis_.Command(cmd);
-  return DB::kOK;
+  freeReplyObject(reply);
+  return bytes;
 }
 
 } // namespace ycsbc
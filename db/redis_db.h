@@ -44,11 +44,17 @@ class RedisDB : public DB {
   }
 
   int Delete(const std::string &table, const std::string &key) {
-    std::string cmd("DEL " + key);
-    redis_.Command(cmd);
+    const char *argv[2] = { "DEL", key.data() };
+    const size_t argvlen[2] = { 3, key.size() };
+    redis_.Command(2, argv, argvlen);
     return DB::kOK;
   }
 
+  ///
+  /// Reports used_memory from the server's INFO.
+  ///
+  uint64_t MemoryUsage();
+
  private:
   RedisClient redis_;
 };
@@ -14,6 +14,7 @@
 #include <cstring>
 
 
+#include "rocksdb/table.h"
 #include "rocksdb/utilities/options_util.h"
 
 using namespace std;
@@ -27,7 +28,8 @@ RocksDB::RocksDB(utils::Properties &props) {
   if(option_file_ != "") {
     cout << "RocksDB options file: " << option_file_ << endl;
   }
-
+  block_cache_size_ = stoull(props.GetProperty(kPropertyRocksdbBlockCacheSize, "0"));
+  write_buffer_manager_size_ = stoull(props.GetProperty(kPropertyRocksdbWriteBufferManagerSize, "0"));
 }
 
 void RocksDB::Init() {
@@ -35,6 +37,13 @@ void RocksDB::Init() {
   if(rocksdb_ == nullptr) {
     try {
       cout << "Initializing RocksDB..." << endl;
+      if (block_cache_size_ > 0) {
+        block_cache_ = rocksdb::NewLRUCache(block_cache_size_);
+      }
+      if (write_buffer_manager_size_ > 0) {
+        write_buffer_manager_ = make_shared<rocksdb::WriteBufferManager>(
+            write_buffer_manager_size_, block_cache_);
+      }
       if (option_file_ != "") {
         rocksdb_ = InitRocksDBWithOptionsFile();
       } else {
@@ -61,6 +70,10 @@ rocksdb::DB* RocksDB::InitRocksDBWithOptionsFile() {
   if(!s.ok()) {
     throw utils::Exception(s.ToString());
   }
+  ShareWriteBuffers(options);
+  for (auto & cf_descriptor : cf_descriptors) {
+    ShareCache(cf_descriptor.options);
+  }
   db_options_ = options;
 
   s = rocksdb::DB::Open(options, rocksdb_dir_, cf_descriptors, &cf_handles, &db);
@@ -86,6 +99,7 @@ rocksdb::DB* RocksDB::InitRocksDB() {
   for(const string & cf_name: cf_names) {
     auto && cf_options = rocksdb::ColumnFamilyOptions();
     cf_options.OptimizeLevelStyleCompaction();
+    ShareCache(cf_options);
     auto && cf_descriptor = rocksdb::ColumnFamilyDescriptor(cf_name, cf_options);
     cf_optionss.push_back(cf_options);
     cf_descriptors.push_back(cf_descriptor);
@@ -101,6 +115,8 @@ rocksdb::DB* RocksDB::InitRocksDB() {
     options.IncreaseParallelism(rocks_threads);
     options.max_background_compactions = rocks_threads;
     options.info_log_level = rocksdb::INFO_LEVEL;
+    ShareCache(options);
+    ShareWriteBuffers(options);
     db_options_ = options;
     s = rocksdb::DB::Open(options, rocksdb_dir_, &db);
     if(!s.ok()) {
@@ -114,6 +130,7 @@ rocksdb::DB* RocksDB::InitRocksDB() {
     options.IncreaseParallelism(rocks_threads);
     options.max_background_compactions = rocks_threads;
     options.info_log_level = rocksdb::INFO_LEVEL;
+    ShareWriteBuffers(options);
     db_options_ = options;
 
     vector<rocksdb::ColumnFamilyHandle*> cf_handles;
@@ -142,6 +159,8 @@ void RocksDB::Close() {
 
     rocksdb::Status s = rocksdb_->Close();
     rocksdb_ = nullptr;
+    write_buffer_manager_.reset();
+    block_cache_.reset();
 
     SaveColumnFamilyNames();
     column_families_.clear();
@@ -262,6 +281,50 @@ int RocksDB::Delete(const std::string &table, const std::string &key) {
   return DB::kOK;
 }
 
+uint64_t RocksDB::MemoryUsage() {
+  unique_lock<mutex> lock(mutex_);
+  if (rocksdb_ == nullptr) return 0;
+  uint64_t total = 0;
+  if (block_cache_) {
+    // Summing the cache usage of every column family would count the shared
+    // cache once per family. Memtables charged to it show in its usage too.
+    total += block_cache_->GetUsage();
+    if (!write_buffer_manager_) {
+      uint64_t value = 0;
+      if (rocksdb_->GetAggregatedIntProperty("rocksdb.cur-size-all-mem-tables", &value)) {
+        total += value;
+      }
+    }
+    uint64_t value = 0;
+    if (rocksdb_->GetAggregatedIntProperty("rocksdb.estimate-table-readers-mem", &value)) {
+      total += value;
+    }
+    return total;
+  }
+  for (const char *property : {"rocksdb.cur-size-all-mem-tables",
+                               "rocksdb.estimate-table-readers-mem",
+                               "rocksdb.block-cache-usage"}) {
+    uint64_t value = 0;
+    if (rocksdb_->GetAggregatedIntProperty(property, &value)) total += value;
+  }
+  return total;
+}
+
+void RocksDB::ShareCache(rocksdb::ColumnFamilyOptions & cf_options) {
+  if (!block_cache_) return;
+  // Keeps the other table options, from the options file if there is one.
+  rocksdb::BlockBasedTableOptions table_options;
+  const rocksdb::BlockBasedTableOptions *current = cf_options.table_factory ?
+      cf_options.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>() : nullptr;
+  if (current) table_options = *current;
+  table_options.block_cache = block_cache_;
+  cf_options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+}
+
+void RocksDB::ShareWriteBuffers(rocksdb::DBOptions & db_options) {
+  if (write_buffer_manager_) db_options.write_buffer_manager = write_buffer_manager_;
+}
+
 void RocksDB::SaveColumnFamilyNames() {
   try {
     ofstream fout(rocksdb_dir_ + "/" + kColumnFamilyNamesFilename);
@@ -330,6 +393,7 @@ void RocksDB::CreateColumnFamily(const std::string & name) {
     } else {
       cf_options.OptimizeLevelStyleCompaction();
     }
+    ShareCache(cf_options);
     cout << "Option OK!" << endl;
     rocksdb::ColumnFamilyHandle *cf_handle = nullptr;
     rocksdb::Status s = rocksdb_->CreateColumnFamily(cf_options, name, &cf_handle);
@@ -15,6 +15,8 @@
 #include "core/properties.h"
 #include "tbb/concurrent_unordered_map.h"
 #include "rocksdb/db.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/write_buffer_manager.h"
 
 namespace ycsbc {
 
@@ -42,6 +44,11 @@ class RocksDB : public DB {
 
   int Delete(const std::string &table, const std::string &key);
 
+  ///
+  /// Sums memtables, table readers and the block cache.
+  ///
+  uint64_t MemoryUsage();
+
  private:
   
   struct ColumnFamily
@@ -56,10 +63,19 @@ class RocksDB : public DB {
   
   static inline const std::string kPropertyRocksdbDir = "rocksdb.dir";
   static inline const std::string kPropertyRocksdbOptionsFile = "rocksdb.optionsfile";
+  /// Bytes of a block cache shared by all column families, 0 for none
+  static inline const std::string kPropertyRocksdbBlockCacheSize = "rocksdb.blockcachesize";
+  /// Bytes all memtables may take together, charged to the shared block cache
+  static inline const std::string kPropertyRocksdbWriteBufferManagerSize =
+      "rocksdb.writebuffermanagersize";
   static inline const std::string kColumnFamilyNamesFilename = "CF_NAMES";
   static inline std::string rocksdb_dir_ = "";
   static inline std::string option_file_ = "";
   static inline rocksdb::DBOptions db_options_{};
+  static inline size_t block_cache_size_ = 0;
+  static inline size_t write_buffer_manager_size_ = 0;
+  static inline std::shared_ptr<rocksdb::Cache> block_cache_{};
+  static inline std::shared_ptr<rocksdb::WriteBufferManager> write_buffer_manager_{};
   static inline rocksdb::DB *rocksdb_ = nullptr;
   static inline int references_ = 0;
   static inline std::mutex mutex_{};
@@ -87,6 +103,13 @@ class RocksDB : public DB {
   std::vector<std::string> LoadColumnFamilyNames();
 
   void CreateColumnFamily(const std::string & name);
+
+  ///
+  /// Points the options at the block cache and write buffer manager that
+  /// all column families share, if configured.
+  ///
+  void ShareCache(rocksdb::ColumnFamilyOptions & cf_options);
+  void ShareWriteBuffers(rocksdb::DBOptions & db_options);
   rocksdb::ColumnFamilyOptions GetDefaultColumnFamilyOptions(const std::string & name);
 
   std::string SerializeValues(const std::vector<KVPair> & values);
@@ -0,0 +1,27 @@
+//
+//  skiplist_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_SKIPLIST_DB_H_
+#define YCSB_C_SKIPLIST_DB_H_
+
+#include "db/lock_free_db.h"
+
+#include "lib/skiplist_hashtable.h"
+
+namespace ycsbc {
+
+///
+/// Keeps records in a lock-free skiplist ordered by key, so Scan returns
+/// the records that follow the start key in key order.
+///
+class SkiplistDB : public LockFreeDB {
+ public:
+  SkiplistDB() : LockFreeDB(
+      new vmp::SkiplistHashtable<vmp::FlatRecord *, SlabAlloc>) { }
+};
+
+} // ycsbc
+
+#endif // YCSB_C_SKIPLIST_DB_H_
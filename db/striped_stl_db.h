@@ -0,0 +1,24 @@
+//
+//  striped_stl_db.h
+//  YCSB-C
+//
+
+#ifndef YCSB_C_STRIPED_STL_DB_H_
+#define YCSB_C_STRIPED_STL_DB_H_
+
+#include "db/hashtable_db.h"
+
+#include "lib/striped_stl_hashtable.h"
+
+namespace ycsbc {
+
+class StripedStlDB : public HashtableDB {
+ public:
+  StripedStlDB(std::size_t num_shards) : HashtableDB(
+      new vmp::StripedStlHashtable<vmp::FlatRecord *, SlabAlloc>(
+          num_shards)) { }
+};
+
+} // ycsbc
+
+#endif // YCSB_C_STRIPED_STL_DB_H_
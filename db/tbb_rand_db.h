@@ -11,8 +11,6 @@
 
 #include "db/hashtable_db.h"
 
-#include <string>
-#include <vector>
 #include "lib/tbb_rand_hashtable.h"
 
 namespace ycsbc {
@@ -20,38 +18,7 @@ namespace ycsbc {
 class TbbRandDB : public HashtableDB {
  public:
   TbbRandDB() : HashtableDB(
-      new vmp::TbbRandHashtable<HashtableDB::FieldHashtable *>) { }
-
-  ~TbbRandDB() {
-    std::vector<KeyHashtable::KVPair> key_pairs = key_table_->Entries();
-    for (auto &key_pair : key_pairs) {
-      DeleteFieldHashtable(key_pair.second);
-    }
-    delete key_table_;
-  }
-
- protected:
-  HashtableDB::FieldHashtable *NewFieldHashtable() {
-    return new vmp::TbbRandHashtable<const char *>;
-  }
-
-  void DeleteFieldHashtable(HashtableDB::FieldHashtable *table) {
-    std::vector<FieldHashtable::KVPair> pairs = table->Entries();
-    for (auto &pair : pairs) {
-      DeleteString(pair.second);
-    }
-    delete table;
-  }
-
-  const char *CopyString(const std::string &str) {
-    char *value = new char[str.length() + 1];
-    strcpy(value, str.c_str());
-    return value;
-  }
-
-  void DeleteString(const char *str) {
-    delete[] str;
-  }
+      new vmp::TbbRandHashtable<vmp::FlatRecord *, SlabAlloc>) { }
 };
 
 } // ycsbc
@@ -0,0 +1,341 @@
+//
+//  validating_db.h
+//  YCSB-C
+//
+//  Forwards every operation to another DB and checks what reads return.
+//
+
+#ifndef YCSB_C_VALIDATING_DB_H_
+#define YCSB_C_VALIDATING_DB_H_
+
+#include "core/db.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "core/utils.h"
+#include "lib/string.h"
+
+namespace ycsbc {
+
+///
+/// Writes to a sample of the keys stamp every field value with a 12-byte
+/// header: the low half of the key hash, the version of the write, and a
+/// checksum over both, the field name and the rest of the value. Reads of
+/// those keys check the header, and that the newest version among all the
+/// fields read is at least the one committed before the read started and
+/// at most the one in flight when it ended. Versions live in a fixed-size
+/// open-addressing table of 16 bytes per sampled key.
+///
+/// Writes to a sampled key are serialized by a lock bit in its slot, so
+/// that versions reach the DB in order. Keys outside the sample cost one
+/// hash per operation. Scans and fields shorter than the header are not
+/// checked, and reads of single fields only get the integrity checks.
+///
+class ValidatingDB : public DB {
+ public:
+  ///
+  /// The name of the property for turning validation on.
+  ///
+  static inline const std::string VALIDATE_PROPERTY = "validate";
+  static inline const std::string VALIDATE_DEFAULT = "false";
+
+  ///
+  /// The name of the property for the fraction of keys to validate.
+  ///
+  static inline const std::string VALIDATE_SAMPLE_PROPERTY = "validate.sample";
+  static inline const std::string VALIDATE_SAMPLE_DEFAULT = "0.01";
+
+  ///
+  /// @param sample The fraction of keys whose values are stamped and checked.
+  /// @param max_keys The most keys the run may write, which sizes the table.
+  ///
+  ValidatingDB(DB &db, double sample, uint64_t max_keys);
+
+  void Init() { db_.Init(); }
+  void Close() { db_.Close(); }
+
+  int Read(const std::string &table, const std::string &key,
+           const std::vector<std::string> *fields,
+           std::vector<KVPair> &result);
+
+  int Scan(const std::string &table, const std::string &key,
+           int len, const std::vector<std::string> *fields,
+           std::vector<std::vector<KVPair>> &result) {
+    return db_.Scan(table, key, len, fields, result);
+  }
+
+  int Update(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    return Write(false, table, key, values);
+  }
+
+  int Insert(const std::string &table, const std::string &key,
+             std::vector<KVPair> &values) {
+    return Write(true, table, key, values);
+  }
+
+  int Delete(const std::string &table, const std::string &key);
+
+  uint64_t MemoryUsage() { return db_.MemoryUsage(); }
+
+  /// Prints the counts of checked reads and of each kind of error.
+  void Report(std::ostream &out) const;
+
+  /// Returns the number of errors found so far.
+  uint64_t errors() const;
+
+ private:
+  static const std::size_t kHeaderSize = 12;
+  static const int kMaxPrintedErrors = 10;
+
+  // The state of a slot is version << 2 | deleted << 1 | locked.
+  static const uint64_t kLocked = 1;
+  static const uint64_t kDeleted = 2;
+
+  struct Slot {
+    std::atomic<uint64_t> tag;   ///< Key hash, or 0 for an empty slot
+    std::atomic<uint64_t> state;
+  };
+
+  enum Error { CORRUPT, WRONG_KEY, STALE, FUTURE, MISSING, kNumErrors };
+
+  uint64_t KeyHash(const std::string &table, const std::string &key) const;
+  bool Sampled(uint64_t hash) const { return hash <= threshold_; }
+  /// Returns the slot of the key, or NULL if absent and not created.
+  Slot *FindSlot(uint64_t hash, bool create);
+  static uint64_t Lock(Slot &slot);
+
+  static uint32_t Checksum(uint32_t key_check, uint32_t version,
+                           const std::string &field, const std::string &value);
+  static void Stamp(uint64_t hash, uint32_t version,
+                    std::vector<KVPair> &values);
+  int Write(bool insert, const std::string &table, const std::string &key,
+            std::vector<KVPair> &values);
+  void Fail(Error error, const std::string &table, const std::string &key,
+            const std::string &detail);
+
+  DB &db_;
+  uint64_t threshold_; ///< Keys whose hash is at most this are sampled
+  std::unique_ptr<Slot[]> slots_;
+  uint64_t mask_;
+  std::atomic<uint64_t> checked_;
+  std::atomic<uint64_t> untracked_; ///< Sampled keys the table had no room for
+  std::atomic<uint64_t> errors_[kNumErrors];
+};
+
+//
+// Implementation
+//
+inline ValidatingDB::ValidatingDB(DB &db, double sample, uint64_t max_keys) :
+    db_(db), checked_(0), untracked_(0) {
+  if (sample <= 0 || sample > 1) {
+    throw utils::Exception("validate.sample must be in (0, 1]");
+  }
+  threshold_ = sample >= 1 ? UINT64_MAX : (uint64_t)(sample * 0x1p64);
+  // Keeps the table at most half full.
+  uint64_t size = 1024;
+  while (size < 2 * sample * max_keys) size *= 2;
+  slots_.reset(new Slot[size]);
+  for (uint64_t i = 0; i < size; ++i) {
+    slots_[i].tag.store(0, std::memory_order_relaxed);
+    slots_[i].state.store(0, std::memory_order_relaxed);
+  }
+  mask_ = size - 1;
+  for (std::atomic<uint64_t> &count : errors_) count.store(0);
+}
+
+inline uint64_t ValidatingDB::KeyHash(const std::string &table,
+                                      const std::string &key) const {
+  const uint64_t hash = vmp::String::Hash(key.data(), key.size()) ^
+      utils::SplitMix64(vmp::String::Hash(table.data(), table.size()));
+  return hash ? hash : 1; // 0 marks empty slots
+}
+
+inline ValidatingDB::Slot *ValidatingDB::FindSlot(uint64_t hash, bool create) {
+  // Sampled hashes are small when the sample is, so they are mixed first.
+  uint64_t i = utils::SplitMix64(hash) & mask_;
+  for (uint64_t probes = 0; probes <= mask_; ++probes, i = (i + 1) & mask_) {
+    uint64_t tag = slots_[i].tag.load(std::memory_order_acquire);
+    if (tag == 0) {
+      if (!create) return NULL;
+      if (slots_[i].tag.compare_exchange_strong(tag, hash)) return &slots_[i];
+    }
+    if (tag == hash) return &slots_[i];
+  }
+  return NULL;
+}
+
+inline uint64_t ValidatingDB::Lock(Slot &slot) {
+  uint64_t state = slot.state.load(std::memory_order_relaxed);
+  while (true) {
+    if (state & kLocked) {
+      std::this_thread::yield();
+      state = slot.state.load(std::memory_order_relaxed);
+    } else if (slot.state.compare_exchange_weak(state, state | kLocked,
+                                                std::memory_order_acquire)) {
+      return state;
+    }
+  }
+}
+
+inline uint32_t ValidatingDB::Checksum(uint32_t key_check, uint32_t version,
+                                       const std::string &field,
+                                       const std::string &value) {
+  uint64_t sum = vmp::String::Hash(value.data() + kHeaderSize,
+                                   value.size() - kHeaderSize);
+  sum ^= vmp::String::Hash(field.data(), field.size()) * 31;
+  sum ^= utils::SplitMix64((uint64_t)key_check << 32 | version);
+  return sum ^ sum >> 32;
+}
+
+inline void ValidatingDB::Stamp(uint64_t hash, uint32_t version,
+                                std::vector<KVPair> &values) {
+  const uint32_t key_check = hash;
+  for (KVPair &pair : values) {
+    std::string &value = pair.second;
+    if (value.size() < kHeaderSize) continue;
+    const uint32_t checksum = Checksum(key_check, version, pair.first, value);
+    memcpy(&value[0], &key_check, 4);
+    memcpy(&value[4], &version, 4);
+    memcpy(&value[8], &checksum, 4);
+  }
+}
+
+inline int ValidatingDB::Write(bool insert, const std::string &table,
+                               const std::string &key,
+                               std::vector<KVPair> &values) {
+  const uint64_t hash = KeyHash(table, key);
+  Slot *slot = Sampled(hash) ? FindSlot(hash, true) : NULL;
+  if (!slot) {
+    if (Sampled(hash)) untracked_.fetch_add(1, std::memory_order_relaxed);
+    return insert ? db_.Insert(table, key, values) :
+                    db_.Update(table, key, values);
+  }
+  const uint64_t state = Lock(*slot);
+  const uint64_t version = (state >> 2) + 1;
+  Stamp(hash, version, values);
+  const int status = insert ? db_.Insert(table, key, values) :
+                              db_.Update(table, key, values);
+  // A failed write leaves the state as it was.
+  slot->state.store(status == kOK ? version << 2 : state,
+                    std::memory_order_release);
+  return status;
+}
+
+inline int ValidatingDB::Delete(const std::string &table,
+                                const std::string &key) {
+  const uint64_t hash = KeyHash(table, key);
+  Slot *slot = Sampled(hash) ? FindSlot(hash, true) : NULL;
+  if (!slot) return db_.Delete(table, key);
+  const uint64_t state = Lock(*slot);
+  const int status = db_.Delete(table, key);
+  slot->state.store((state & ~kLocked) | kDeleted, std::memory_order_release);
+  return status;
+}
+
+inline int ValidatingDB::Read(const std::string &table, const std::string &key,
+                              const std::vector<std::string> *fields,
+                              std::vector<KVPair> &result) {
+  const uint64_t hash = KeyHash(table, key);
+  Slot *slot = Sampled(hash) ? FindSlot(hash, false) : NULL;
+  // Keys never written, or written unstamped, have nothing to check against.
+  if (!slot) return db_.Read(table, key, fields, result);
+  const uint64_t before = slot->state.load(std::memory_order_acquire);
+  const int status = db_.Read(table, key, fields, result);
+  std::atomic_thread_fence(std::memory_order_acquire); // Read, then sample
+  const uint64_t after = slot->state.load(std::memory_order_acquire);
+  checked_.fetch_add(1, std::memory_order_relaxed);
+
+  const uint64_t lower = before >> 2;
+  const uint64_t upper = (after >> 2) + (after & kLocked);
+  // Whether no write was in flight or done during the read.
+  const bool settled = before == after && !(before & kLocked);
+  if (status != kOK) {
+    if (status == kErrorNoData && settled && lower > 0 &&
+        !(before & kDeleted)) {
+      Fail(MISSING, table, key, "version " + std::to_string(lower));
+    }
+    return status;
+  }
+
+  const uint32_t key_check = hash;
+  uint64_t newest = 0;
+  bool stamped = false;
+  for (const KVPair &pair : result) {
+    const std::string &value = pair.second;
+    if (value.size() < kHeaderSize) continue;
+    uint32_t stamped_key, version, checksum;
+    memcpy(&stamped_key, &value[0], 4);
+    memcpy(&version, &value[4], 4);
+    memcpy(&checksum, &value[8], 4);
+    if (checksum != Checksum(stamped_key, version, pair.first, value)) {
+      Fail(CORRUPT, table, key, "field " + pair.first);
+      return status;
+    }
+    if (stamped_key != key_check) {
+      Fail(WRONG_KEY, table, key, "field " + pair.first);
+      return status;
+    }
+    newest = std::max<uint64_t>(newest, version);
+    stamped = true;
+  }
+  if (newest > upper) {
+    Fail(FUTURE, table, key, "version " + std::to_string(newest) +
+         " after " + std::to_string(upper));
+  } else if (!fields && stamped && newest < lower) {
+    Fail(STALE, table, key, "version " + std::to_string(newest) +
+         " before " + std::to_string(lower));
+  } else if (!fields && settled && (before & kDeleted) && lower > 0) {
+    Fail(STALE, table, key, "deleted at version " + std::to_string(lower));
+  }
+  return status;
+}
+
+inline void ValidatingDB::Fail(Error error, const std::string &table,
+                               const std::string &key,
+                               const std::string &detail) {
+  static const char *kNames[kNumErrors] = {"corrupt", "wrong key", "stale",
+                                           "future", "missing"};
+  if (errors_[error].fetch_add(1, std::memory_order_relaxed) >=
+      (uint64_t)kMaxPrintedErrors) {
+    return;
+  }
+  std::string printable;
+  for (unsigned char c : key) {
+    if (isprint(c)) {
+      printable += c;
+    } else {
+      static const char *kHex = "0123456789abcdef";
+      printable.append("\\x").append(1, kHex[c >> 4]).append(1, kHex[c & 15]);
+    }
+  }
+  std::cerr << "Validation error (" << kNames[error] << "): " << table << '/'
+            << printable << ": " << detail << std::endl;
+}
+
+inline uint64_t ValidatingDB::errors() const {
+  uint64_t sum = 0;
+  for (const std::atomic<uint64_t> &count : errors_) sum += count.load();
+  return sum;
+}
+
+inline void ValidatingDB::Report(std::ostream &out) const {
+  out << "# Validation:\t" << checked_.load() << " reads checked\t"
+      << errors_[CORRUPT].load() << " corrupt\t"
+      << errors_[WRONG_KEY].load() << " wrong key\t"
+      << errors_[STALE].load() << " stale\t"
+      << errors_[FUTURE].load() << " future\t"
+      << errors_[MISSING].load() << " missing";
+  if (untracked_.load()) out << "\t" << untracked_.load() << " untracked writes";
+  out << std::endl;
+}
+
+} // ycsbc
+
+#endif // YCSB_C_VALIDATING_DB_H_
@@ -0,0 +1,678 @@
+//
+//  art_hashtable.h
+//
+//  An adaptive radix tree (ART) with optimistic lock coupling behind the
+//  StringHashtable interface.
+//
+
+#ifndef YCSB_C_LIB_ART_HASHTABLE_H_
+#define YCSB_C_LIB_ART_HASHTABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "lib/epoch.h"
+#include "lib/string.h"
+
+namespace vmp {
+
+///
+/// Inner nodes adapt between 4, 16, 48 and 256 children and compress
+/// common prefixes; leaves hold the full key, including its terminating
+/// '\0' so that no key is a prefix of another. Readers traverse without
+/// locks and validate node versions; writers lock at most a node and its
+/// parent. Nodes replaced on growth or prefix splits are retired through
+/// Epoch. As in SkiplistHashtable, leaves are never removed: a NULL value
+/// marks an absent key and a reinsert revives it. Values must not be NULL.
+///
+/// Entries(key, n) returns the first n keys not less than key, in
+/// String::Compare order. Keys holding '\0' bytes must all be of the same
+/// length, or one may become a prefix of another.
+///
+template<class V, class MA = MemAlloc>
+class ArtHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  ArtHashtable() : root_(new N256(NULL, 0)) { }
+  ~ArtHashtable() { FreeTree(reinterpret_cast<Ref>(root_)); }
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const { return Entries().size(); }
+
+ private:
+  /// Tagged child reference: a Leaf pointer if the low bit is set.
+  typedef uintptr_t Ref;
+
+  /// Prefix bytes stored in a node; longer prefixes are read from a leaf.
+  static constexpr uint32_t kMaxPrefix = 16;
+
+  enum NodeType : uint8_t { kN4, kN16, kN48, kN256 };
+
+  struct Leaf {
+    String key;
+    std::atomic<V> value;
+    Leaf(const String &k, V v) : key(k), value(v) { }
+  };
+
+  ///
+  /// The version word holds an obsolete bit (bit 0), a lock bit (bit 1)
+  /// and a counter bumped on every write unlock. The prefix is immutable;
+  /// a node whose prefix must shrink is replaced by a copy.
+  ///
+  struct Node {
+    std::atomic<uint64_t> version;
+    const NodeType type;
+    const uint32_t prefix_len;
+    uint8_t prefix[kMaxPrefix];
+    std::atomic<uint16_t> count;
+
+    Node(NodeType t, const uint8_t *p, uint32_t len) :
+        version(0), type(t), prefix_len(len), count(0) {
+      if (len) std::copy(p, p + std::min(len, kMaxPrefix), prefix);
+    }
+  };
+
+  struct N4 : Node {
+    std::atomic<uint8_t> keys[4];
+    std::atomic<Ref> children[4];
+    N4(const uint8_t *p, uint32_t len) : Node(kN4, p, len) { }
+  };
+
+  struct N16 : Node {
+    std::atomic<uint8_t> keys[16];
+    std::atomic<Ref> children[16];
+    N16(const uint8_t *p, uint32_t len) : Node(kN16, p, len) { }
+  };
+
+  struct N48 : Node {
+    std::atomic<uint8_t> index[256]; ///< Slot + 1, or 0 if absent
+    std::atomic<Ref> children[48];
+    N48(const uint8_t *p, uint32_t len) : Node(kN48, p, len) {
+      for (auto &i : index) i.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  struct N256 : Node {
+    std::atomic<Ref> children[256];
+    N256(const uint8_t *p, uint32_t len) : Node(kN256, p, len) {
+      for (auto &c : children) c.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  static bool IsLeaf(Ref ref) { return ref & 1; }
+  static Leaf *AsLeaf(Ref ref) { return reinterpret_cast<Leaf *>(ref & ~1); }
+  static Node *AsNode(Ref ref) { return reinterpret_cast<Node *>(ref); }
+  static Ref LeafRef(Leaf *leaf) { return reinterpret_cast<Ref>(leaf) | 1; }
+  static Ref NodeRef(Node *node) { return reinterpret_cast<Ref>(node); }
+
+  // Optimistic lock coupling; each sets restart on a conflict.
+  static uint64_t ReadLock(const Node *node, bool &restart);
+  static void Check(const Node *node, uint64_t version, bool &restart);
+  static void Upgrade(Node *node, uint64_t version, bool &restart);
+  static void WriteUnlock(Node *node) { node->version.fetch_add(2); }
+  static void WriteUnlockObsolete(Node *node) { node->version.fetch_add(3); }
+
+  // Node operations; writers must hold the node's lock.
+  static Ref GetChild(const Node *node, uint8_t byte);
+  static bool IsFull(const Node *node);
+  static void AddChild(Node *node, uint8_t byte, Ref child);
+  static void ChangeChild(Node *node, uint8_t byte, Ref child);
+  static int Children(const Node *node, uint8_t *bytes, Ref *refs);
+  static Node *Grow(const Node *node);
+  static Node *CopyWithPrefix(const Node *node, const uint8_t *p,
+                              uint32_t len);
+  static void DeleteNode(void *node);
+  static void FreeTree(Ref ref);
+
+  ///
+  /// Returns the full prefix of node, which begins at depth of the key.
+  /// Long prefixes are read from any leaf below, as all of them share it.
+  /// Returns NULL if a concurrent writer got in the way.
+  ///
+  static const uint8_t *Prefix(const Node *node, uint32_t depth);
+
+  Leaf *FindLeaf(const String &key) const;
+  bool Scan(const Node *node, uint32_t depth, const String &key,
+            bool bounded, std::vector<KVPair> &pairs, std::size_t n) const;
+
+  Node *const root_; ///< Never replaced, as a N256 never grows
+};
+
+template<class V, class MA>
+inline uint64_t ArtHashtable<V, MA>::ReadLock(const Node *node,
+                                              bool &restart) {
+  uint64_t version = node->version.load();
+  if (version & 3) restart = true;
+  return version;
+}
+
+template<class V, class MA>
+inline void ArtHashtable<V, MA>::Check(const Node *node, uint64_t version,
+                                       bool &restart) {
+  if (node->version.load() != version) restart = true;
+}
+
+template<class V, class MA>
+inline void ArtHashtable<V, MA>::Upgrade(Node *node, uint64_t version,
+                                         bool &restart) {
+  if (!node->version.compare_exchange_strong(version, version + 2)) {
+    restart = true;
+  }
+}
+
+template<class V, class MA>
+typename ArtHashtable<V, MA>::Ref ArtHashtable<V, MA>::GetChild(
+    const Node *node, uint8_t byte) {
+  switch (node->type) {
+    case kN4: {
+      const N4 *n = static_cast<const N4 *>(node);
+      int count = std::min<int>(n->count.load(std::memory_order_acquire), 4);
+      for (int i = 0; i < count; ++i) {
+        if (n->keys[i].load(std::memory_order_relaxed) == byte) {
+          return n->children[i].load(std::memory_order_acquire);
+        }
+      }
+      return 0;
+    }
+    case kN16: {
+      const N16 *n = static_cast<const N16 *>(node);
+      int count = std::min<int>(n->count.load(std::memory_order_acquire), 16);
+      for (int i = 0; i < count; ++i) {
+        if (n->keys[i].load(std::memory_order_relaxed) == byte) {
+          return n->children[i].load(std::memory_order_acquire);
+        }
+      }
+      return 0;
+    }
+    case kN48: {
+      const N48 *n = static_cast<const N48 *>(node);
+      uint8_t slot = n->index[byte].load(std::memory_order_acquire);
+      if (!slot) return 0;
+      return n->children[slot - 1].load(std::memory_order_acquire);
+    }
+    case kN256: {
+      const N256 *n = static_cast<const N256 *>(node);
+      return n->children[byte].load(std::memory_order_acquire);
+    }
+  }
+  return 0;
+}
+
+template<class V, class MA>
+bool ArtHashtable<V, MA>::IsFull(const Node *node) {
+  static const uint16_t kCapacity[] = { 4, 16, 48, 256 };
+  return node->count.load(std::memory_order_relaxed) ==
+      kCapacity[node->type];
+}
+
+template<class V, class MA>
+void ArtHashtable<V, MA>::AddChild(Node *node, uint8_t byte, Ref child) {
+  uint16_t count = node->count.load(std::memory_order_relaxed);
+  switch (node->type) {
+    case kN4:
+    case kN16: {
+      // Both keep their keys sorted, so they share the layout logic.
+      std::atomic<uint8_t> *keys;
+      std::atomic<Ref> *children;
+      if (node->type == kN4) {
+        keys = static_cast<N4 *>(node)->keys;
+        children = static_cast<N4 *>(node)->children;
+      } else {
+        keys = static_cast<N16 *>(node)->keys;
+        children = static_cast<N16 *>(node)->children;
+      }
+      int pos = count;
+      while (pos > 0 && keys[pos - 1].load(std::memory_order_relaxed) > byte) {
+        keys[pos].store(keys[pos - 1].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+        children[pos].store(children[pos - 1].load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+        --pos;
+      }
+      keys[pos].store(byte, std::memory_order_relaxed);
+      children[pos].store(child, std::memory_order_release);
+      break;
+    }
+    case kN48: {
+      N48 *n = static_cast<N48 *>(node);
+      n->children[count].store(child, std::memory_order_release);
+      n->index[byte].store(count + 1, std::memory_order_release);
+      break;
+    }
+    case kN256: {
+      N256 *n = static_cast<N256 *>(node);
+      n->children[byte].store(child, std::memory_order_release);
+      break;
+    }
+  }
+  node->count.store(count + 1, std::memory_order_release);
+}
+
+template<class V, class MA>
+void ArtHashtable<V, MA>::ChangeChild(Node *node, uint8_t byte, Ref child) {
+  switch (node->type) {
+    case kN4: {
+      N4 *n = static_cast<N4 *>(node);
+      for (int i = 0; i < n->count.load(std::memory_order_relaxed); ++i) {
+        if (n->keys[i].load(std::memory_order_relaxed) == byte) {
+          n->children[i].store(child, std::memory_order_release);
+        }
+      }
+      break;
+    }
+    case kN16: {
+      N16 *n = static_cast<N16 *>(node);
+      for (int i = 0; i < n->count.load(std::memory_order_relaxed); ++i) {
+        if (n->keys[i].load(std::memory_order_relaxed) == byte) {
+          n->children[i].store(child, std::memory_order_release);
+        }
+      }
+      break;
+    }
+    case kN48: {
+      N48 *n = static_cast<N48 *>(node);
+      uint8_t slot = n->index[byte].load(std::memory_order_relaxed);
+      n->children[slot - 1].store(child, std::memory_order_release);
+      break;
+    }
+    case kN256: {
+      N256 *n = static_cast<N256 *>(node);
+      n->children[byte].store(child, std::memory_order_release);
+      break;
+    }
+  }
+}
+
+template<class V, class MA>
+int ArtHashtable<V, MA>::Children(const Node *node, uint8_t *bytes,
+                                  Ref *refs) {
+  int num = 0;
+  switch (node->type) {
+    case kN4: {
+      const N4 *n = static_cast<const N4 *>(node);
+      int count = std::min<int>(n->count.load(std::memory_order_acquire), 4);
+      for (int i = 0; i < count; ++i) {
+        bytes[num] = n->keys[i].load(std::memory_order_relaxed);
+        refs[num++] = n->children[i].load(std::memory_order_acquire);
+      }
+      break;
+    }
+    case kN16: {
+      const N16 *n = static_cast<const N16 *>(node);
+      int count = std::min<int>(n->count.load(std::memory_order_acquire), 16);
+      for (int i = 0; i < count; ++i) {
+        bytes[num] = n->keys[i].load(std::memory_order_relaxed);
+        refs[num++] = n->children[i].load(std::memory_order_acquire);
+      }
+      break;
+    }
+    case kN48: {
+      const N48 *n = static_cast<const N48 *>(node);
+      for (int b = 0; b < 256; ++b) {
+        uint8_t slot = n->index[b].load(std::memory_order_acquire);
+        if (!slot) continue;
+        bytes[num] = b;
+        refs[num++] = n->children[slot - 1].load(std::memory_order_acquire);
+      }
+      break;
+    }
+    case kN256: {
+      const N256 *n = static_cast<const N256 *>(node);
+      for (int b = 0; b < 256; ++b) {
+        Ref ref = n->children[b].load(std::memory_order_acquire);
+        if (!ref) continue;
+        bytes[num] = b;
+        refs[num++] = ref;
+      }
+      break;
+    }
+  }
+  return num;
+}
+
+template<class V, class MA>
+typename ArtHashtable<V, MA>::Node *ArtHashtable<V, MA>::Grow(
+    const Node *node) {
+  uint8_t bytes[256];
+  Ref refs[256];
+  int num = Children(node, bytes, refs);
+  Node *big;
+  switch (node->type) {
+    case kN4: big = new N16(node->prefix, node->prefix_len); break;
+    case kN16: big = new N48(node->prefix, node->prefix_len); break;
+    default: big = new N256(node->prefix, node->prefix_len); break;
+  }
+  for (int i = 0; i < num; ++i) {
+    AddChild(big, bytes[i], refs[i]);
+  }
+  return big;
+}
+
+template<class V, class MA>
+typename ArtHashtable<V, MA>::Node *ArtHashtable<V, MA>::CopyWithPrefix(
+    const Node *node, const uint8_t *p, uint32_t len) {
+  uint8_t bytes[256];
+  Ref refs[256];
+  int num = Children(node, bytes, refs);
+  Node *copy;
+  switch (node->type) {
+    case kN4: copy = new N4(p, len); break;
+    case kN16: copy = new N16(p, len); break;
+    case kN48: copy = new N48(p, len); break;
+    default: copy = new N256(p, len); break;
+  }
+  for (int i = 0; i < num; ++i) {
+    AddChild(copy, bytes[i], refs[i]);
+  }
+  return copy;
+}
+
+template<class V, class MA>
+void ArtHashtable<V, MA>::DeleteNode(void *p) {
+  Node *node = static_cast<Node *>(p);
+  switch (node->type) {
+    case kN4: delete static_cast<N4 *>(node); break;
+    case kN16: delete static_cast<N16 *>(node); break;
+    case kN48: delete static_cast<N48 *>(node); break;
+    case kN256: delete static_cast<N256 *>(node); break;
+  }
+}
+
+template<class V, class MA>
+void ArtHashtable<V, MA>::FreeTree(Ref ref) {
+  if (IsLeaf(ref)) {
+    Leaf *leaf = AsLeaf(ref);
+    String::Free<MA>(leaf->key);
+    delete leaf;
+    return;
+  }
+  uint8_t bytes[256];
+  Ref refs[256];
+  int num = Children(AsNode(ref), bytes, refs);
+  for (int i = 0; i < num; ++i) {
+    FreeTree(refs[i]);
+  }
+  DeleteNode(AsNode(ref));
+}
+
+template<class V, class MA>
+const uint8_t *ArtHashtable<V, MA>::Prefix(const Node *node, uint32_t depth) {
+  if (node->prefix_len <= kMaxPrefix) return node->prefix;
+  Ref ref = NodeRef(const_cast<Node *>(node));
+  while (ref && !IsLeaf(ref)) {
+    uint8_t bytes[256];
+    Ref refs[256];
+    ref = Children(AsNode(ref), bytes, refs) ? refs[0] : 0;
+  }
+  if (!ref) return NULL;
+  return reinterpret_cast<const uint8_t *>(AsLeaf(ref)->key.value()) + depth;
+}
+
+template<class V, class MA>
+typename ArtHashtable<V, MA>::Leaf *ArtHashtable<V, MA>::FindLeaf(
+    const String &key) const {
+  const uint8_t *k = reinterpret_cast<const uint8_t *>(key.value());
+  const uint32_t len = key.length() + 1;
+  while (true) {
+    bool restart = false;
+    const Node *node = root_;
+    uint64_t v = ReadLock(node, restart);
+    uint32_t depth = 0;
+    while (!restart) {
+      // Compares the stored part of the prefix only and skips the rest;
+      // the full key is checked at the leaf.
+      uint32_t stored = std::min(node->prefix_len, kMaxPrefix);
+      for (uint32_t i = 0; i < stored; ++i) {
+        if (node->prefix[i] != k[depth + i]) {
+          Check(node, v, restart);
+          if (restart) break;
+          return NULL;
+        }
+      }
+      if (restart) break;
+      depth += node->prefix_len;
+      if (depth >= len) {
+        Check(node, v, restart);
+        if (restart) break;
+        return NULL;
+      }
+
+      Ref child = GetChild(node, k[depth]);
+      Check(node, v, restart);
+      if (restart) break;
+      if (!child) return NULL;
+      if (IsLeaf(child)) {
+        Leaf *leaf = AsLeaf(child);
+        return leaf->key == key ? leaf : NULL;
+      }
+
+      uint64_t cv = ReadLock(AsNode(child), restart);
+      Check(node, v, restart);
+      node = AsNode(child);
+      v = cv;
+      ++depth;
+    }
+  }
+}
+
+template<class V, class MA>
+V ArtHashtable<V, MA>::Get(const String &key) const {
+  Epoch::Guard guard;
+  Leaf *leaf = FindLeaf(key);
+  return leaf ? leaf->value.load(std::memory_order_acquire) : NULL;
+}
+
+template<class V, class MA>
+V ArtHashtable<V, MA>::Update(const String &key, V value) {
+  Epoch::Guard guard;
+  Leaf *leaf = FindLeaf(key);
+  if (!leaf) return NULL;
+  V old = leaf->value.load(std::memory_order_acquire);
+  while (old && !leaf->value.compare_exchange_weak(old, value)) { }
+  return old;
+}
+
+template<class V, class MA>
+bool ArtHashtable<V, MA>::Replace(const String &key, V expected, V desired) {
+  Epoch::Guard guard;
+  Leaf *leaf = FindLeaf(key);
+  if (!leaf || !expected) return false;
+  return leaf->value.compare_exchange_strong(expected, desired);
+}
+
+template<class V, class MA>
+V ArtHashtable<V, MA>::Remove(const String &key) {
+  Epoch::Guard guard;
+  Leaf *leaf = FindLeaf(key);
+  return leaf ? leaf->value.exchange(NULL) : NULL;
+}
+
+template<class V, class MA>
+bool ArtHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value() || !value) return false;
+  Epoch::Guard guard;
+  const uint8_t *k = reinterpret_cast<const uint8_t *>(key.value());
+  Leaf *fresh = NULL;
+
+  while (true) {
+    bool restart = false;
+    Node *node = root_;
+    Node *parent = NULL;
+    uint64_t v = ReadLock(node, restart);
+    uint64_t pv = 0;
+    uint8_t parent_byte = 0;
+    uint32_t depth = 0;
+
+    while (!restart) {
+      if (node->prefix_len) {
+        const uint8_t *prefix = Prefix(node, depth);
+        if (!prefix) {
+          restart = true;
+          break;
+        }
+        // No prefix contains '\0', so this stops within the key.
+        uint32_t p = 0;
+        while (p < node->prefix_len && prefix[p] == k[depth + p]) ++p;
+        Check(node, v, restart);
+        if (restart) break;
+
+        if (p < node->prefix_len) { // Splits the prefix above node
+          Upgrade(parent, pv, restart);
+          if (restart) break;
+          Upgrade(node, v, restart);
+          if (restart) {
+            WriteUnlock(parent);
+            break;
+          }
+          if (!fresh) fresh = new Leaf(String::Copy<MA>(key), value);
+          Node *split = new N4(prefix, p);
+          Node *rest = CopyWithPrefix(node, prefix + p + 1,
+                                      node->prefix_len - p - 1);
+          AddChild(split, prefix[p], NodeRef(rest));
+          AddChild(split, k[depth + p], LeafRef(fresh));
+          ChangeChild(parent, parent_byte, NodeRef(split));
+          WriteUnlock(parent);
+          WriteUnlockObsolete(node);
+          Epoch::Retire(node, DeleteNode);
+          return true;
+        }
+        depth += node->prefix_len;
+      }
+
+      const uint8_t byte = k[depth];
+      Ref child = GetChild(node, byte);
+      Check(node, v, restart);
+      if (restart) break;
+
+      if (!child) {
+        if (IsFull(node)) { // Replaces node with a bigger one
+          Upgrade(parent, pv, restart);
+          if (restart) break;
+          Upgrade(node, v, restart);
+          if (restart) {
+            WriteUnlock(parent);
+            break;
+          }
+          if (!fresh) fresh = new Leaf(String::Copy<MA>(key), value);
+          Node *big = Grow(node);
+          AddChild(big, byte, LeafRef(fresh));
+          ChangeChild(parent, parent_byte, NodeRef(big));
+          WriteUnlock(parent);
+          WriteUnlockObsolete(node);
+          Epoch::Retire(node, DeleteNode);
+        } else {
+          Upgrade(node, v, restart);
+          if (restart) break;
+          if (!fresh) fresh = new Leaf(String::Copy<MA>(key), value);
+          AddChild(node, byte, LeafRef(fresh));
+          WriteUnlock(node);
+        }
+        return true;
+      }
+
+      if (IsLeaf(child)) {
+        Leaf *leaf = AsLeaf(child);
+        if (leaf->key == key) { // Revives an existing key
+          if (fresh) {
+            String::Free<MA>(fresh->key);
+            delete fresh;
+          }
+          V expected = NULL;
+          return leaf->value.compare_exchange_strong(expected, value);
+        }
+        // Pushes the existing leaf down under a node for both keys.
+        Upgrade(node, v, restart);
+        if (restart) break;
+        if (!fresh) fresh = new Leaf(String::Copy<MA>(key), value);
+        const uint8_t *lk = reinterpret_cast<const uint8_t *>(
+            leaf->key.value());
+        uint32_t p = 0;
+        while (lk[depth + 1 + p] == k[depth + 1 + p]) ++p;
+        Node *split = new N4(k + depth + 1, p);
+        AddChild(split, lk[depth + 1 + p], child);
+        AddChild(split, k[depth + 1 + p], LeafRef(fresh));
+        ChangeChild(node, byte, NodeRef(split));
+        WriteUnlock(node);
+        return true;
+      }
+
+      parent = node;
+      pv = v;
+      parent_byte = byte;
+      node = AsNode(child);
+      v = ReadLock(node, restart);
+      Check(parent, pv, restart);
+      ++depth;
+    }
+  }
+}
+
+template<class V, class MA>
+bool ArtHashtable<V, MA>::Scan(const Node *node, uint32_t depth,
+    const String &key, bool bounded, std::vector<KVPair> &pairs,
+    std::size_t n) const {
+  const uint8_t *k = reinterpret_cast<const uint8_t *>(key.value());
+  bool restart = false;
+  uint64_t v = ReadLock(node, restart);
+  if (restart) return false;
+
+  if (bounded && node->prefix_len) {
+    const uint8_t *prefix = Prefix(node, depth);
+    if (!prefix) return false;
+    int cmp = 0;
+    for (uint32_t i = 0; i < node->prefix_len && !cmp; ++i) {
+      cmp = int(prefix[i]) - int(k[depth + i]);
+    }
+    Check(node, v, restart);
+    if (restart) return false;
+    if (cmp < 0) return true; // The whole subtree sorts before key
+    if (cmp > 0) bounded = false;
+  }
+  depth += node->prefix_len;
+
+  uint8_t bytes[256];
+  Ref refs[256];
+  int num = Children(node, bytes, refs);
+  Check(node, v, restart);
+  if (restart) return false;
+
+  for (int i = 0; i < num && pairs.size() < n; ++i) {
+    if (bounded && bytes[i] < k[depth]) continue;
+    bool child_bounded = bounded && bytes[i] == k[depth];
+    if (IsLeaf(refs[i])) {
+      Leaf *leaf = AsLeaf(refs[i]);
+      if (child_bounded && String::Compare(leaf->key, key) < 0) continue;
+      V value = leaf->value.load(std::memory_order_acquire);
+      if (value) pairs.push_back(std::make_pair(leaf->key, value));
+    } else if (!Scan(AsNode(refs[i]), depth + 1, key, child_bounded,
+                     pairs, n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<class V, class MA>
+std::vector<typename ArtHashtable<V, MA>::KVPair>
+ArtHashtable<V, MA>::Entries(const String *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  Epoch::Guard guard;
+  while (!Scan(root_, 0, key ? *key : String(), key != NULL, pairs, n)) {
+    pairs.clear();
+  }
+  return pairs;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_ART_HASHTABLE_H_
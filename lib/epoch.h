@@ -0,0 +1,223 @@
+//
+//  epoch.h
+//
+//  Epoch-based memory reclamation shared by the concurrent in-memory
+//  engines. Readers pin the current epoch with an Epoch::Guard; writers
+//  Retire() objects they have unlinked, which are freed once every thread
+//  that could still see them has left its critical section.
+//
+
+#ifndef YCSB_C_LIB_EPOCH_H_
+#define YCSB_C_LIB_EPOCH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace vmp {
+
+class Epoch {
+  struct ThreadState;
+
+ public:
+  typedef void (*Deleter)(void *);
+
+  ///
+  /// Pins the calling thread to the current epoch for the lifetime of the
+  /// guard. Guards may be nested.
+  ///
+  class Guard {
+   public:
+    Guard();
+    ~Guard();
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+   private:
+    ThreadState &state_;
+  };
+
+  ///
+  /// Defers deleter(p) until no guard that might have observed p is alive.
+  /// The caller must have already unlinked p from any shared structure.
+  ///
+  static void Retire(void *p, Deleter deleter);
+
+  template <typename T>
+  static void Retire(T *p) {
+    Retire((void *)p, [](void *q) { delete static_cast<T *>(q); });
+  }
+
+  ///
+  /// Number of retired objects not yet freed, for diagnostics.
+  ///
+  static std::size_t Pending();
+
+  ///
+  /// Frees what the calling thread and exited threads retired, provided no
+  /// guard is active, as between runs. Objects that other live threads
+  /// retired stay with them.
+  ///
+  static void Drain();
+
+ private:
+  static const int kMaxThreads = 1024;
+  static const int kCollectInterval = 64;
+  static const uint64_t kQuiescent = 0;
+
+  struct alignas(64) Record {
+    std::atomic<uint64_t> epoch{kQuiescent};
+    std::atomic<bool> used{false};
+  };
+
+  struct Retired {
+    uint64_t epoch;
+    void *ptr;
+    Deleter deleter;
+  };
+
+  struct Domain {
+    std::atomic<uint64_t> global{1};
+    Record records[kMaxThreads];
+    std::atomic<std::size_t> pending{0};
+    std::mutex orphans_mutex;
+    std::vector<Retired> orphans; ///< Left behind by exited threads
+    ~Domain();
+  };
+
+  static Domain &domain() {
+    static Domain domain;
+    return domain;
+  }
+
+  static ThreadState &Local();
+  static void Enter(ThreadState &state);
+  static void Exit(ThreadState &state);
+  static bool TryAdvance();
+  static void Collect(std::vector<Retired> &limbo, uint64_t global);
+};
+
+struct Epoch::ThreadState {
+  Record *record;
+  int depth;
+  int retires;
+  std::vector<Retired> limbo;
+
+  ThreadState() : depth(0), retires(0) {
+    Domain &d = domain();
+    for (int i = 0; i < kMaxThreads; ++i) {
+      bool expected = false;
+      if (!d.records[i].used.load(std::memory_order_relaxed) &&
+          d.records[i].used.compare_exchange_strong(expected, true)) {
+        record = &d.records[i];
+        return;
+      }
+    }
+    throw std::runtime_error("Epoch: too many threads");
+  }
+
+  ~ThreadState() {
+    Domain &d = domain();
+    record->epoch.store(kQuiescent);
+    record->used.store(false);
+    std::lock_guard<std::mutex> lock(d.orphans_mutex);
+    d.orphans.insert(d.orphans.end(), limbo.begin(), limbo.end());
+  }
+};
+
+//
+// Implementation
+//
+inline Epoch::ThreadState &Epoch::Local() {
+  static thread_local ThreadState state;
+  return state;
+}
+
+inline Epoch::Guard::Guard() : state_(Local()) {
+  if (state_.depth++ == 0) Enter(state_);
+}
+
+inline Epoch::Guard::~Guard() {
+  if (--state_.depth == 0) Exit(state_);
+}
+
+inline void Epoch::Enter(ThreadState &state) {
+  std::atomic<uint64_t> &global = domain().global;
+  uint64_t e;
+  // Re-checks so that an epoch advanced concurrently is never missed.
+  do {
+    e = global.load();
+    state.record->epoch.store(e);
+  } while (e != global.load());
+}
+
+inline void Epoch::Exit(ThreadState &state) {
+  state.record->epoch.store(kQuiescent, std::memory_order_release);
+}
+
+inline void Epoch::Retire(void *p, Deleter deleter) {
+  ThreadState &state = Local();
+  Domain &d = domain();
+  state.limbo.push_back({d.global.load(), p, deleter});
+  d.pending.fetch_add(1, std::memory_order_relaxed);
+  if (++state.retires % kCollectInterval == 0) {
+    TryAdvance();
+    Collect(state.limbo, d.global.load());
+    std::unique_lock<std::mutex> lock(d.orphans_mutex, std::try_to_lock);
+    if (lock.owns_lock() && !d.orphans.empty()) {
+      Collect(d.orphans, d.global.load());
+    }
+  }
+}
+
+inline std::size_t Epoch::Pending() {
+  return domain().pending.load(std::memory_order_relaxed);
+}
+
+inline void Epoch::Drain() {
+  Domain &d = domain();
+  // Two epochs on, nothing retired so far can still be seen.
+  TryAdvance();
+  TryAdvance();
+  const uint64_t global = d.global.load();
+  Collect(Local().limbo, global);
+  std::lock_guard<std::mutex> lock(d.orphans_mutex);
+  Collect(d.orphans, global);
+}
+
+inline bool Epoch::TryAdvance() {
+  Domain &d = domain();
+  uint64_t e = d.global.load();
+  for (int i = 0; i < kMaxThreads; ++i) {
+    uint64_t local = d.records[i].epoch.load();
+    if (local != kQuiescent && local != e) return false;
+  }
+  return d.global.compare_exchange_strong(e, e + 1);
+}
+
+inline void Epoch::Collect(std::vector<Retired> &limbo, uint64_t global) {
+  // Objects retired in epoch e may still be seen by guards of epoch e + 1,
+  // so they are only safe to free two epochs later.
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < limbo.size(); ++i) {
+    if (limbo[i].epoch + 2 <= global) {
+      limbo[i].deleter(limbo[i].ptr);
+    } else {
+      limbo[kept++] = limbo[i];
+    }
+  }
+  domain().pending.fetch_sub(limbo.size() - kept, std::memory_order_relaxed);
+  limbo.resize(kept);
+}
+
+inline Epoch::Domain::~Domain() {
+  // Only reached at process exit, after all guards are gone.
+  for (Retired &r : orphans) {
+    r.deleter(r.ptr);
+  }
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_EPOCH_H_
@@ -0,0 +1,145 @@
+//
+//  flat_record.h
+//
+//  A record whose fields are laid out contiguously in one allocation.
+//
+
+#ifndef YCSB_C_LIB_FLAT_RECORD_H_
+#define YCSB_C_LIB_FLAT_RECORD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "lib/mem_alloc.h"
+
+namespace vmp {
+
+///
+/// A header of 2 * n + 1 offsets is followed by the bytes of all field
+/// names and values, in the order name0, value0, name1, value1, ...
+/// Field i spans offsets [2i, 2i + 1) for its name and [2i + 1, 2i + 2)
+/// for its value. Records are immutable once built; updates produce a new
+/// record with Merge, so readers never see a partial write.
+///
+class FlatRecord {
+ public:
+  typedef std::pair<std::string, std::string> Field;
+
+  template <class Alloc>
+  static FlatRecord *New(const std::vector<Field> &fields);
+
+  ///
+  /// Returns a copy of base with the given fields overwritten, and those
+  /// base lacks appended.
+  ///
+  template <class Alloc>
+  static FlatRecord *Merge(const FlatRecord &base,
+                           const std::vector<Field> &updates);
+
+  template <class Alloc>
+  static void Free(FlatRecord *record);
+
+  std::size_t num_fields() const { return num_fields_; }
+  std::size_t size() const { return size_; } ///< Bytes in the allocation
+
+  std::string_view name(std::size_t i) const { return Item(2 * i); }
+  std::string_view value(std::size_t i) const { return Item(2 * i + 1); }
+
+  /// Returns the index of the named field, or -1 if absent.
+  int Find(std::string_view name) const;
+
+ private:
+  FlatRecord() = delete;
+
+  template <class Alloc>
+  static FlatRecord *Build(const std::vector<std::string_view> &items);
+
+  static std::size_t HeaderSize(std::size_t num_items) {
+    return offsetof(FlatRecord, offsets_) + sizeof(uint32_t) * (num_items + 1);
+  }
+
+  std::string_view Item(std::size_t i) const {
+    const char *data = reinterpret_cast<const char *>(
+        offsets_ + 2 * num_fields_ + 1);
+    return std::string_view(data + offsets_[i], offsets_[i + 1] - offsets_[i]);
+  }
+
+  uint32_t size_;
+  uint32_t num_fields_;
+  uint32_t offsets_[1]; ///< Actually 2 * num_fields_ + 1 entries
+};
+
+template <class Alloc>
+inline FlatRecord *FlatRecord::Build(
+    const std::vector<std::string_view> &items) {
+  std::size_t data_size = 0;
+  for (const std::string_view &item : items) data_size += item.size();
+  const std::size_t header = HeaderSize(items.size());
+
+  FlatRecord *record = (FlatRecord *)Alloc::Malloc(header + data_size);
+  record->size_ = header + data_size;
+  record->num_fields_ = items.size() / 2;
+  char *data = reinterpret_cast<char *>(record) + header;
+  uint32_t offset = 0;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    record->offsets_[i] = offset;
+    memcpy(data + offset, items[i].data(), items[i].size());
+    offset += items[i].size();
+  }
+  record->offsets_[items.size()] = offset;
+  return record;
+}
+
+template <class Alloc>
+inline FlatRecord *FlatRecord::New(const std::vector<Field> &fields) {
+  std::vector<std::string_view> items;
+  items.reserve(fields.size() * 2);
+  for (const Field &field : fields) {
+    items.push_back(field.first);
+    items.push_back(field.second);
+  }
+  return Build<Alloc>(items);
+}
+
+template <class Alloc>
+inline FlatRecord *FlatRecord::Merge(const FlatRecord &base,
+                                     const std::vector<Field> &updates) {
+  std::vector<std::string_view> items;
+  items.reserve((base.num_fields() + updates.size()) * 2);
+  for (std::size_t i = 0; i < base.num_fields(); ++i) {
+    items.push_back(base.name(i));
+    items.push_back(base.value(i));
+  }
+  for (const Field &field : updates) {
+    int i = base.Find(field.first);
+    if (i < 0) {
+      items.push_back(field.first);
+      items.push_back(field.second);
+    } else {
+      items[2 * i + 1] = field.second;
+    }
+  }
+  return Build<Alloc>(items);
+}
+
+template <class Alloc>
+inline void FlatRecord::Free(FlatRecord *record) {
+  Alloc::Free(record, record->size());
+}
+
+inline int FlatRecord::Find(std::string_view name) const {
+  for (std::size_t i = 0; i < num_fields_; ++i) {
+    if (this->name(i) == name) return i;
+  }
+  return -1;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_FLAT_RECORD_H_
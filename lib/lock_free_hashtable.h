@@ -0,0 +1,210 @@
+//
+//  lock_free_hashtable.h
+//
+//  A fixed-capacity, lock-free linear-probing hashtable.
+//
+
+#ifndef YCSB_C_LIB_LOCK_FREE_HASHTABLE_H_
+#define YCSB_C_LIB_LOCK_FREE_HASHTABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <atomic>
+#include <vector>
+#include "lib/string.h"
+
+namespace vmp {
+
+///
+/// Each slot holds a key, claimed once by CAS and never changed afterwards,
+/// and a value swapped by CAS. A NULL value means the key is absent, so
+/// Remove only clears the value and a later Insert of the same key revives
+/// its slot. Probe chains therefore never need tombstones, and the table
+/// fills up only with distinct keys. Values must not be NULL.
+///
+/// A count of claimed slots keeps one slot free, so that every probe for an
+/// absent key ends. Once the count reaches that, inserts of new keys fail
+/// at once and full() turns true.
+///
+/// The table does not free values; callers that race with readers should
+/// retire what Update and Remove return, and what Replace replaced, through
+/// vmp::Epoch.
+///
+template<class V, class MA = MemAlloc>
+class LockFreeHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  ///
+  /// @param capacity Number of slots, rounded up to a power of two. Inserts
+  ///        of new keys fail once all but one have been claimed.
+  ///
+  LockFreeHashtable(std::size_t capacity);
+  ~LockFreeHashtable();
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const;
+
+  /// Whether no slot is left for a new key.
+  bool full() const {
+    return claimed_.load(std::memory_order_relaxed) >= mask_;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<String *> key;
+    std::atomic<V> value;
+  };
+
+  /// Returns the slot claimed by key, or NULL if there is none.
+  Slot *Find(const String &key) const;
+  /// Counts a slot about to be claimed, or returns false if none is left.
+  bool Claim();
+
+  Slot *slots_;
+  std::size_t mask_;
+  std::atomic<std::size_t> claimed_;
+};
+
+template<class V, class MA>
+LockFreeHashtable<V, MA>::LockFreeHashtable(std::size_t capacity) {
+  std::size_t n = 2;
+  while (n < capacity) n <<= 1;
+  slots_ = new Slot[n];
+  for (std::size_t i = 0; i < n; ++i) {
+    slots_[i].key.store(NULL, std::memory_order_relaxed);
+    slots_[i].value.store(NULL, std::memory_order_relaxed);
+  }
+  mask_ = n - 1;
+  claimed_.store(0, std::memory_order_relaxed);
+}
+
+template<class V, class MA>
+LockFreeHashtable<V, MA>::~LockFreeHashtable() {
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    String *key = slots_[i].key.load(std::memory_order_relaxed);
+    if (!key) continue;
+    String::Free<MA>(*key);
+    delete key;
+  }
+  delete[] slots_;
+}
+
+template<class V, class MA>
+typename LockFreeHashtable<V, MA>::Slot *
+LockFreeHashtable<V, MA>::Find(const String &key) const {
+  std::size_t i = key.hash() & mask_;
+  for (std::size_t probes = 0; probes <= mask_; ++probes, i = (i + 1) & mask_) {
+    String *k = slots_[i].key.load(std::memory_order_acquire);
+    if (!k) break;
+    if (*k == key) return &slots_[i];
+  }
+  return NULL;
+}
+
+template<class V, class MA>
+bool LockFreeHashtable<V, MA>::Claim() {
+  if (claimed_.fetch_add(1, std::memory_order_relaxed) < mask_) return true;
+  claimed_.fetch_sub(1, std::memory_order_relaxed);
+  return false;
+}
+
+template<class V, class MA>
+V LockFreeHashtable<V, MA>::Get(const String &key) const {
+  Slot *slot = Find(key);
+  if (!slot) return NULL;
+  return slot->value.load(std::memory_order_acquire);
+}
+
+template<class V, class MA>
+bool LockFreeHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value() || !value) return false;
+  String *fresh = NULL;
+  bool ok = false;
+  std::size_t i = key.hash() & mask_;
+  for (std::size_t probes = 0; probes <= mask_; ++probes, i = (i + 1) & mask_) {
+    String *k = slots_[i].key.load(std::memory_order_acquire);
+    if (!k) {
+      if (!Claim()) break;
+      if (!fresh) fresh = new String(String::Copy<MA>(key));
+      if (slots_[i].key.compare_exchange_strong(k, fresh)) {
+        k = fresh;
+        fresh = NULL;
+      } else { // k now holds the key of the winner, which counted it.
+        claimed_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    if (*k == key) {
+      V expected = NULL;
+      ok = slots_[i].value.compare_exchange_strong(expected, value);
+      break;
+    }
+  }
+  if (fresh) {
+    String::Free<MA>(*fresh);
+    delete fresh;
+  }
+  return ok;
+}
+
+template<class V, class MA>
+V LockFreeHashtable<V, MA>::Update(const String &key, V value) {
+  Slot *slot = Find(key);
+  if (!slot) return NULL;
+  V old = slot->value.load(std::memory_order_acquire);
+  while (old && !slot->value.compare_exchange_weak(old, value)) { }
+  return old;
+}
+
+template<class V, class MA>
+bool LockFreeHashtable<V, MA>::Replace(const String &key, V expected,
+                                       V desired) {
+  Slot *slot = Find(key);
+  if (!slot || !expected) return false;
+  return slot->value.compare_exchange_strong(expected, desired);
+}
+
+template<class V, class MA>
+V LockFreeHashtable<V, MA>::Remove(const String &key) {
+  Slot *slot = Find(key);
+  if (!slot) return NULL;
+  return slot->value.exchange(NULL);
+}
+
+template<class V, class MA>
+std::vector<typename LockFreeHashtable<V, MA>::KVPair>
+LockFreeHashtable<V, MA>::Entries(const String *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  std::size_t i = 0;
+  if (key) {
+    Slot *slot = Find(*key);
+    if (!slot) return pairs;
+    i = slot - slots_;
+  }
+  for (; i <= mask_ && pairs.size() < n; ++i) {
+    V value = slots_[i].value.load(std::memory_order_acquire);
+    if (!value) continue;
+    String *k = slots_[i].key.load(std::memory_order_acquire);
+    pairs.push_back(std::make_pair(*k, value));
+  }
+  return pairs;
+}
+
+template<class V, class MA>
+std::size_t LockFreeHashtable<V, MA>::Size() const {
+  std::size_t size = 0;
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    if (slots_[i].value.load(std::memory_order_relaxed)) ++size;
+  }
+  return size;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_LOCK_FREE_HASHTABLE_H_
@@ -0,0 +1,244 @@
+//
+//  skiplist_hashtable.h
+//
+//  An ordered, lock-free skiplist behind the StringHashtable interface.
+//
+
+#ifndef YCSB_C_LIB_SKIPLIST_HASHTABLE_H_
+#define YCSB_C_LIB_SKIPLIST_HASHTABLE_H_
+
+#include "lib/string_hashtable.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "lib/string.h"
+
+namespace vmp {
+
+///
+/// Keys are kept in String::Compare order, so Entries(key, n) returns the
+/// first n keys not less than key. Towers are linked bottom-up by CAS and are never
+/// unlinked: as in LockFreeHashtable, a NULL value marks an absent key and
+/// a reinsert revives the node. Memory thus stays bounded by the key space
+/// without any reclamation inside the list. Values must not be NULL.
+///
+template<class V, class MA = MemAlloc>
+class SkiplistHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  SkiplistHashtable();
+  ~SkiplistHashtable();
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
+                              std::size_t n = -1) const;
+  std::size_t Size() const;
+
+ private:
+  static const int kMaxHeight = 20;
+  static const unsigned kBranching = 4;
+
+  struct Node {
+    String key;
+    std::atomic<V> value;
+    int height;
+    std::atomic<Node *> next[1]; ///< Actually height entries
+
+    static Node *New(const String &key, V value, int height);
+    static void Free(Node *node);
+  };
+
+  static int RandomHeight();
+  static int Compare(const Node *node, const String &key) {
+    return String::Compare(node->key, key);
+  }
+
+  ///
+  /// Returns the first node whose key is not less than key. If preds is
+  /// given, fills in the last node before key on every level.
+  ///
+  Node *FindGreaterOrEqual(const String &key, Node **preds) const;
+
+  Node *head_;
+  std::atomic<int> height_;
+};
+
+template<class V, class MA>
+typename SkiplistHashtable<V, MA>::Node *
+SkiplistHashtable<V, MA>::Node::New(const String &key, V value, int height) {
+  void *mem = ::operator new(
+      sizeof(Node) + sizeof(std::atomic<Node *>) * (height - 1));
+  Node *node = static_cast<Node *>(mem);
+  new (&node->key) String(key);
+  new (&node->value) std::atomic<V>(value);
+  node->height = height;
+  for (int i = 0; i < height; ++i) {
+    new (&node->next[i]) std::atomic<Node *>(NULL);
+  }
+  return node;
+}
+
+template<class V, class MA>
+void SkiplistHashtable<V, MA>::Node::Free(Node *node) {
+  if (node->key.value()) String::Free<MA>(node->key);
+  ::operator delete(node);
+}
+
+template<class V, class MA>
+SkiplistHashtable<V, MA>::SkiplistHashtable() : height_(1) {
+  head_ = Node::New(String(), NULL, kMaxHeight);
+}
+
+template<class V, class MA>
+SkiplistHashtable<V, MA>::~SkiplistHashtable() {
+  Node *node = head_;
+  while (node) {
+    Node *next = node->next[0].load(std::memory_order_relaxed);
+    Node::Free(node);
+    node = next;
+  }
+}
+
+template<class V, class MA>
+int SkiplistHashtable<V, MA>::RandomHeight() {
+  static thread_local uint64_t seed = uint64_t(&seed) | 1;
+  // xorshift64
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  uint64_t bits = seed;
+  int height = 1;
+  while (height < kMaxHeight && (bits % kBranching) == 0) {
+    ++height;
+    bits /= kBranching;
+  }
+  return height;
+}
+
+template<class V, class MA>
+typename SkiplistHashtable<V, MA>::Node *
+SkiplistHashtable<V, MA>::FindGreaterOrEqual(const String &key,
+                                             Node **preds) const {
+  Node *x = head_;
+  int level = height_.load(std::memory_order_relaxed) - 1;
+  if (preds) {
+    for (int i = kMaxHeight - 1; i > level; --i) preds[i] = head_;
+  }
+  while (true) {
+    Node *next = x->next[level].load(std::memory_order_acquire);
+    if (next && Compare(next, key) < 0) {
+      x = next;
+    } else {
+      if (preds) preds[level] = x;
+      if (level == 0) return next;
+      --level;
+    }
+  }
+}
+
+template<class V, class MA>
+V SkiplistHashtable<V, MA>::Get(const String &key) const {
+  Node *node = FindGreaterOrEqual(key, NULL);
+  if (!node || Compare(node, key) != 0) return NULL;
+  return node->value.load(std::memory_order_acquire);
+}
+
+template<class V, class MA>
+bool SkiplistHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value() || !value) return false;
+  Node *preds[kMaxHeight];
+  Node *fresh = NULL;
+  Node *succ;
+  while (true) {
+    succ = FindGreaterOrEqual(key, preds);
+    if (succ && Compare(succ, key) == 0) break;
+
+    if (!fresh) fresh = Node::New(String::Copy<MA>(key), value, RandomHeight());
+    fresh->next[0].store(succ, std::memory_order_relaxed);
+    if (preds[0]->next[0].compare_exchange_strong(succ, fresh)) break;
+  }
+
+  if (succ && Compare(succ, key) == 0) { // Revive an existing key
+    if (fresh) Node::Free(fresh);
+    V expected = NULL;
+    return succ->value.compare_exchange_strong(expected, value);
+  }
+
+  // Raises the list height first so that searches can reach upper levels.
+  int height = height_.load(std::memory_order_relaxed);
+  while (fresh->height > height &&
+         !height_.compare_exchange_weak(height, fresh->height)) { }
+
+  for (int i = 1; i < fresh->height; ++i) {
+    while (true) {
+      Node *next = preds[i]->next[i].load(std::memory_order_acquire);
+      // Another insert may have linked nodes in between since the search.
+      while (next && Compare(next, key) < 0) {
+        preds[i] = next;
+        next = next->next[i].load(std::memory_order_acquire);
+      }
+      fresh->next[i].store(next, std::memory_order_relaxed);
+      if (preds[i]->next[i].compare_exchange_strong(next, fresh)) break;
+    }
+  }
+  return true;
+}
+
+template<class V, class MA>
+V SkiplistHashtable<V, MA>::Update(const String &key, V value) {
+  Node *node = FindGreaterOrEqual(key, NULL);
+  if (!node || Compare(node, key) != 0) return NULL;
+  V old = node->value.load(std::memory_order_acquire);
+  while (old && !node->value.compare_exchange_weak(old, value)) { }
+  return old;
+}
+
+template<class V, class MA>
+bool SkiplistHashtable<V, MA>::Replace(const String &key, V expected,
+                                       V desired) {
+  Node *node = FindGreaterOrEqual(key, NULL);
+  if (!node || Compare(node, key) != 0 || !expected) return false;
+  return node->value.compare_exchange_strong(expected, desired);
+}
+
+template<class V, class MA>
+V SkiplistHashtable<V, MA>::Remove(const String &key) {
+  Node *node = FindGreaterOrEqual(key, NULL);
+  if (!node || Compare(node, key) != 0) return NULL;
+  return node->value.exchange(NULL);
+}
+
+template<class V, class MA>
+std::vector<typename SkiplistHashtable<V, MA>::KVPair>
+SkiplistHashtable<V, MA>::Entries(const String *key, std::size_t n) const {
+  std::vector<KVPair> pairs;
+  Node *node = key ? FindGreaterOrEqual(*key, NULL) :
+      head_->next[0].load(std::memory_order_acquire);
+  for (; node && pairs.size() < n;
+       node = node->next[0].load(std::memory_order_acquire)) {
+    V value = node->value.load(std::memory_order_acquire);
+    if (value) pairs.push_back(std::make_pair(node->key, value));
+  }
+  return pairs;
+}
+
+template<class V, class MA>
+std::size_t SkiplistHashtable<V, MA>::Size() const {
+  std::size_t size = 0;
+  Node *node = head_->next[0].load(std::memory_order_acquire);
+  for (; node; node = node->next[0].load(std::memory_order_acquire)) {
+    if (node->value.load(std::memory_order_relaxed)) ++size;
+  }
+  return size;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_SKIPLIST_HASHTABLE_H_
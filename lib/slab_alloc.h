@@ -0,0 +1,277 @@
+//
+//  slab_alloc.h
+//
+//  A per-thread size-class slab allocator with the MemAlloc interface.
+//
+
+#ifndef YCSB_C_LIB_SLAB_ALLOC_H_
+#define YCSB_C_LIB_SLAB_ALLOC_H_
+
+#include <sys/mman.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+///
+/// Blocks up to kMaxSmall bytes are rounded up to a multiple of kGrain and
+/// served from per-thread free lists, refilled by carving 2 MB chunks that
+/// are never returned to the system. A block freed by another thread joins
+/// that thread's list, as all blocks of a class are interchangeable.
+/// Larger blocks go to malloc. Callers must pass the allocation size to
+/// Free, as they already do for MemAlloc.
+///
+/// Configure() must run before the first allocation, and cannot turn the
+/// slabs on or off while blocks are live: each block must go back to the
+/// allocator it came from.
+///
+struct SlabAlloc {
+  struct Stats {
+    uint64_t allocations;  ///< Live blocks, including those from malloc
+    uint64_t bytes;        ///< Bytes in live blocks, after rounding
+    uint64_t reserved;     ///< Bytes mapped for chunks, plus large blocks
+  };
+
+  ///
+  /// @param enabled If false, every call passes through to malloc/free.
+  /// @param huge_pages Back chunks with huge pages where available.
+  /// @return False, changing nothing, if enabled would change while blocks
+  ///         are live.
+  ///
+  static bool Configure(bool enabled, bool huge_pages) {
+    Global &g = global();
+    if (enabled != g.enabled && GetStats().allocations > 0) return false;
+    g.enabled = enabled;
+    g.huge_pages = huge_pages;
+    return true;
+  }
+
+  static bool enabled() { return global().enabled; }
+
+  static void *Malloc(std::size_t size);
+
+  template <typename T>
+  static void Free(T *p, std::size_t size) { FreeBlock((void *)p, size); }
+
+  template <typename T, typename... Arguments>
+  static T *New(Arguments... args) {
+    return new (Malloc(sizeof(T))) T(args...);
+  }
+
+  template <typename T>
+  static void Delete(T *p) {
+    p->~T();
+    Free(p, sizeof(T));
+  }
+
+  static Stats GetStats();
+
+ private:
+  static const std::size_t kGrain = 16;
+  static const std::size_t kMaxSmall = 4096;
+  static const std::size_t kNumClasses = kMaxSmall / kGrain + 1;
+  static const std::size_t kChunkSize = 2 << 20;
+
+  struct Block {
+    Block *next;
+  };
+
+  struct Cache {
+    Block *free_lists[kNumClasses] = {};
+    char *cursor = NULL;
+    char *end = NULL;
+    // Written only by the owning thread; read by GetStats().
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    std::atomic<uint64_t> freed_bytes{0};
+    /// Net blocks passed through to malloc while disabled, which may wrap
+    /// in a cache that frees more of them than it allocated.
+    std::atomic<uint64_t> passthrough{0};
+
+    void Count(std::atomic<uint64_t> &counter, uint64_t n) {
+      counter.store(counter.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+    }
+  };
+
+  struct Global {
+    bool enabled = true;
+    bool huge_pages = false;
+    std::atomic<uint64_t> reserved{0};
+    std::atomic<uint64_t> large_blocks{0};
+    std::atomic<uint64_t> large_bytes{0};
+    std::mutex mutex;
+    std::vector<Cache *> caches; ///< Every cache ever made, for stats
+    std::vector<Cache *> idle;   ///< Left by exited threads for reuse
+  };
+
+  ///
+  /// Hands the thread's cache back to the idle list when the thread exits.
+  ///
+  struct Releaser {
+    ~Releaser();
+  };
+
+  static Global &global() {
+    static Global *g = new Global; // Outlives every thread and static
+    return *g;
+  }
+
+  static std::size_t ClassSize(std::size_t size) {
+    return size ? (size + kGrain - 1) / kGrain * kGrain : kGrain;
+  }
+
+  static Cache *&local() {
+    static thread_local Cache *cache = NULL;
+    return cache;
+  }
+
+  static bool &exited() {
+    static thread_local bool exited = false;
+    return exited;
+  }
+
+  static Cache *Local();
+  static char *MapChunk();
+  static void FreeBlock(void *p, std::size_t size);
+};
+
+//
+// Implementation
+//
+inline SlabAlloc::Releaser::~Releaser() {
+  exited() = true;
+  Cache *&cache = local();
+  if (!cache) return;
+  Global &g = global();
+  std::lock_guard<std::mutex> lock(g.mutex);
+  g.idle.push_back(cache);
+  cache = NULL;
+}
+
+inline SlabAlloc::Cache *SlabAlloc::Local() {
+  Cache *&cache = local();
+  if (cache || exited()) return cache;
+
+  Global &g = global();
+  {
+    std::lock_guard<std::mutex> lock(g.mutex);
+    if (!g.idle.empty()) {
+      cache = g.idle.back();
+      g.idle.pop_back();
+    } else {
+      cache = new Cache;
+      g.caches.push_back(cache);
+    }
+  }
+  static thread_local Releaser releaser;
+  (void)releaser;
+  return cache;
+}
+
+inline char *SlabAlloc::MapChunk() {
+  Global &g = global();
+  void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (g.huge_pages) {
+    p = mmap(NULL, kChunkSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  if (p == MAP_FAILED) {
+    p = mmap(NULL, kChunkSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    // Falls back to transparent huge pages if none are reserved.
+    if (g.huge_pages) madvise(p, kChunkSize, MADV_HUGEPAGE);
+#endif
+  }
+  g.reserved.fetch_add(kChunkSize, std::memory_order_relaxed);
+  return static_cast<char *>(p);
+}
+
+inline void *SlabAlloc::Malloc(std::size_t size) {
+  Global &g = global();
+  if (!g.enabled) {
+    Cache *cache = Local();
+    if (cache) cache->Count(cache->passthrough, 1);
+    return malloc(size);
+  }
+  if (size > kMaxSmall) {
+    g.large_blocks.fetch_add(1, std::memory_order_relaxed);
+    g.large_bytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size);
+  }
+
+  const std::size_t class_size = ClassSize(size);
+  Cache *cache = Local();
+  if (!cache) return malloc(class_size); // Thread is exiting
+
+  void *p;
+  Block *&head = cache->free_lists[class_size / kGrain];
+  if (head) {
+    p = head;
+    head = head->next;
+  } else {
+    if (cache->cursor + class_size > cache->end) {
+      cache->cursor = MapChunk(); // The tail of the old chunk is dropped
+      cache->end = cache->cursor + kChunkSize;
+    }
+    p = cache->cursor;
+    cache->cursor += class_size;
+  }
+  cache->Count(cache->allocations, 1);
+  cache->Count(cache->allocated_bytes, class_size);
+  return p;
+}
+
+inline void SlabAlloc::FreeBlock(void *p, std::size_t size) {
+  if (!p) return;
+  Global &g = global();
+  if (!g.enabled) {
+    Cache *cache = Local();
+    if (cache) cache->Count(cache->passthrough, -1);
+    free(p);
+    return;
+  }
+  if (size > kMaxSmall) {
+    g.large_blocks.fetch_sub(1, std::memory_order_relaxed);
+    g.large_bytes.fetch_sub(size, std::memory_order_relaxed);
+    free(p);
+    return;
+  }
+
+  const std::size_t class_size = ClassSize(size);
+  Cache *cache = Local();
+  if (!cache) return; // Thread is exiting; the block is simply dropped
+
+  Block *block = static_cast<Block *>(p);
+  Block *&head = cache->free_lists[class_size / kGrain];
+  block->next = head;
+  head = block;
+  cache->Count(cache->frees, 1);
+  cache->Count(cache->freed_bytes, class_size);
+}
+
+inline SlabAlloc::Stats SlabAlloc::GetStats() {
+  Global &g = global();
+  const uint64_t large = g.large_bytes.load(std::memory_order_relaxed);
+  Stats stats = {g.large_blocks.load(std::memory_order_relaxed), large,
+                 g.reserved.load(std::memory_order_relaxed) + large};
+  std::lock_guard<std::mutex> lock(g.mutex);
+  for (Cache *cache : g.caches) {
+    stats.allocations += cache->allocations.load(std::memory_order_relaxed) -
+        cache->frees.load(std::memory_order_relaxed) +
+        cache->passthrough.load(std::memory_order_relaxed);
+    stats.bytes += cache->allocated_bytes.load(std::memory_order_relaxed) -
+        cache->freed_bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+#endif // YCSB_C_LIB_SLAB_ALLOC_H_
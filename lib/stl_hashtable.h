@@ -23,12 +23,14 @@ class StlHashtable : public StringHashtable<V> {
   typedef typename StringHashtable<V>::KVPair KVPair;
 
   StlHashtable(std::size_t num_buckets = 11, float max_load_factor = 2.0);
-
-  V Get(const char *key) const; ///< Returns NULL if the key is not found
-  bool Insert(const char *key, V value);
-  V Update(const char *key, V value);
-  V Remove(const char *key);
-  std::vector<KVPair> Entries(const char *key = NULL,
+  ~StlHashtable();
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
                               std::size_t n = -1) const;
   std::size_t Size() const { return table_.size(); }
 
@@ -51,22 +53,27 @@ StlHashtable<V, MA, PA>::StlHashtable(std::size_t n, float f) : table_(n) {
 }
 
 template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Get(const char *key) const {
-  typename Hashtable::const_iterator pos = table_.find(String::Wrap(key));
+StlHashtable<V, MA, PA>::~StlHashtable() {
+  for (const auto &pair : table_) String::Free<MA>(pair.first);
+}
+
+template<class V, class MA, class PA>
+V StlHashtable<V, MA, PA>::Get(const String &key) const {
+  typename Hashtable::const_iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
   else return pos->second;
 }
 
 template<class V, class MA, class PA>
-bool StlHashtable<V, MA, PA>::Insert(const char *key, V value) {
-  if (!key) return false;
+bool StlHashtable<V, MA, PA>::Insert(const String &key, V value) {
+  if (!key.value()) return false;
   String skey = String::Copy<MA>(key);
   return table_.insert(std::make_pair(skey, value)).second;
 }
 
 template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Update(const char *key, V value) {
-  typename Hashtable::iterator pos = table_.find(String::Wrap(key));
+V StlHashtable<V, MA, PA>::Update(const String &key, V value) {
+  typename Hashtable::iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
   V old = pos->second;
   pos->second = value;
@@ -74,8 +81,17 @@ V StlHashtable<V, MA, PA>::Update(const char *key, V value) {
 }
 
 template<class V, class MA, class PA>
-V StlHashtable<V, MA, PA>::Remove(const char *key) {
-  typename Hashtable::const_iterator pos = table_.find(String::Wrap(key));
+bool StlHashtable<V, MA, PA>::Replace(const String &key, V expected,
+                                      V desired) {
+  typename Hashtable::iterator pos = table_.find(key);
+  if (pos == table_.end() || pos->second != expected) return false;
+  pos->second = desired;
+  return true;
+}
+
+template<class V, class MA, class PA>
+V StlHashtable<V, MA, PA>::Remove(const String &key) {
+  typename Hashtable::const_iterator pos = table_.find(key);
   if (pos == table_.end()) return NULL;
   String::Free<MA>(pos->first);
   V old = pos->second;
@@ -85,16 +101,16 @@ V StlHashtable<V, MA, PA>::Remove(const char *key) {
 
 template<class V, class MA, class PA>
 std::vector<typename StlHashtable<V, MA, PA>::KVPair>
-StlHashtable<V, MA, PA>::Entries(const char *key, std::size_t n) const {
+StlHashtable<V, MA, PA>::Entries(const String *key, std::size_t n) const {
   std::vector<KVPair> pairs;
   typename Hashtable::const_iterator pos;
   if (!key) {
     pos = table_.cbegin();
   } else {
-    pos = table_.find(String::Wrap(key));
+    pos = table_.find(*key);
   }
   for (std::size_t i = 0; pos != table_.end() && i < n; ++pos, ++i) {
-    pairs.push_back(std::make_pair(pos->first.value(), pos->second));
+    pairs.push_back(std::make_pair(pos->first, pos->second));
   }
   return pairs;
 }
@@ -8,6 +8,7 @@
 #ifndef YCSB_C_LIB_HASH_STRING_H_
 #define YCSB_C_LIB_HASH_STRING_H_
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <cassert>
@@ -23,39 +24,117 @@ class String {
   uint64_t hash() const { return hash_; }
   const char *value() const { return value_; }
   size_t length() const { return len_; }
-  void set_value(const char *v);
+  void set_value(const char *v) { set_value(v, strlen(v)); }
+  void set_value(const char *v, size_t len);
 
   template <class Alloc>
   static String Copy(const char *v);
 
+  /// Copies the value, reusing its length and hash.
+  template <class Alloc>
+  static String Copy(const String &str);
+
   static String Wrap(const char *v);
 
+  ///
+  /// Skips the strlen, e.g. for the c_str() of a std::string of known size.
+  /// v[len] must still be '\0'.
+  ///
+  static String Wrap(const char *v, size_t len);
+
   template <class Alloc>
   static void Free(const String& str);
 
   bool operator==(const String &other) const;
 
+  ///
+  /// Orders by bytes as unsigned chars, and a prefix before longer keys,
+  /// so keys may hold '\0' bytes.
+  ///
+  static int Compare(const String &a, const String &b);
+
+  /// The hash of len bytes that hash() returns for a String of them.
+  static uint64_t Hash(const char *str, size_t len);
+
  private:
-  uint64_t SDBMHash(const char *str);
+  static uint64_t Mix(uint64_t a, uint64_t b);
+  static uint64_t Read8(const char *p);
+  static uint64_t Read4(const char *p);
 
   uint64_t hash_;
   const char *value_;
   size_t len_;
 };
 
-inline void String::set_value(const char *v) {
+inline void String::set_value(const char *v, size_t len) {
   value_ = v;
-  len_ = strlen(value_);
-  hash_ = SDBMHash(value_);
+  len_ = len;
+  hash_ = Hash(value_, len_);
+}
+
+inline uint64_t String::Mix(uint64_t a, uint64_t b) {
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+inline uint64_t String::Read8(const char *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t String::Read4(const char *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
 }
 
-inline uint64_t String::SDBMHash(const char *cstr) {
-  uint64_t hash = 0;
-  uint64_t c;
-  while ((c = *cstr++) != '\0') {
-    hash = c + (hash << 6) + (hash << 16) - hash;
+///
+/// wyhash: consumes 16 or 48 bytes per step with 64x64->128 bit multiplies,
+/// so a typical 24-byte YCSB key costs a handful of instructions and its
+/// trailing digits still reach every bit of the result.
+///
+inline uint64_t String::Hash(const char *p, size_t len) {
+  static const uint64_t s0 = 0xa0761d6478bd642full;
+  static const uint64_t s1 = 0xe7037ed1a0b428dbull;
+  static const uint64_t s2 = 0x8ebc6af09c88c6e3ull;
+  static const uint64_t s3 = 0x589965cc75374cc3ull;
+  uint64_t seed = s0;
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      const size_t q = (len >> 3) << 2;
+      a = (Read4(p) << 32) | Read4(p + q);
+      b = (Read4(p + len - 4) << 32) | Read4(p + len - 4 - q);
+    } else if (len > 0) {
+      a = ((uint64_t)(uint8_t)p[0] << 16) |
+          ((uint64_t)(uint8_t)p[len >> 1] << 8) | (uint8_t)p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = Mix(Read8(p) ^ s1, Read8(p + 8) ^ seed);
+        see1 = Mix(Read8(p + 16) ^ s2, Read8(p + 24) ^ see1);
+        see2 = Mix(Read8(p + 32) ^ s3, Read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = Mix(Read8(p) ^ s1, Read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = Read8(p + i - 16);
+    b = Read8(p + i - 8);
   }
-  return hash;
+  return Mix(s1 ^ len, Mix(a ^ s1, b ^ seed));
 }
 
 template <class Alloc>
@@ -64,8 +143,19 @@ inline String String::Copy(const char *cstr) {
   String hstr;
   const size_t len = strlen(cstr); 
   char *str = (char *)Alloc::Malloc(len + 1);
-  hstr.set_value(strcpy(str, cstr));
-  assert(hstr.length() == len);
+  hstr.set_value((char *)memcpy(str, cstr, len + 1), len);
+  return hstr;
+}
+
+template <class Alloc>
+inline String String::Copy(const String &other) {
+  assert(other.value());
+  String hstr;
+  char *str = (char *)Alloc::Malloc(other.length() + 1);
+  memcpy(str, other.value(), other.length() + 1);
+  hstr.value_ = str;
+  hstr.len_ = other.length();
+  hstr.hash_ = other.hash();
   return hstr;
 }
 
@@ -76,14 +166,28 @@ inline String String::Wrap(const char *cstr) {
   return hstr;
 }
 
+inline String String::Wrap(const char *cstr, size_t len) {
+  assert(cstr && cstr[len] == '\0');
+  String hstr;
+  hstr.set_value(cstr, len);
+  return hstr;
+}
+
 template <class Alloc>
 inline void String::Free(const String& hstr) {
   Alloc::Free(hstr.value(), hstr.length() + 1);
 }
 
 inline bool String::operator==(const String &other) const {
-  if (hash_ != other.hash()) return false;
-  return strcmp(value_, other.value()) == 0;
+  if (hash_ != other.hash() || len_ != other.length()) return false;
+  return memcmp(value_, other.value(), len_) == 0;
+}
+
+inline int String::Compare(const String &a, const String &b) {
+  const int cmp = memcmp(a.value(), b.value(), std::min(a.length(),
+                                                        b.length()));
+  if (cmp) return cmp;
+  return a.length() < b.length() ? -1 : a.length() > b.length();
 }
 
 } // vmp
@@ -9,19 +9,29 @@
 #define YCSB_C_LIB_STRING_HASHTABLE_H_
 
 #include <vector>
+#include "lib/string.h"
 
 namespace vmp {
 
 template <class V>
 class StringHashtable {
  public:
-  typedef std::pair<const char *, V> KVPair;
-
-  virtual V Get(const char *key) const = 0; ///< Returns NULL if not found
-  virtual bool Insert(const char *key, V value) = 0;
-  virtual V Update(const char *key, V value) = 0;
-  virtual V Remove(const char *key) = 0;
-  virtual std::vector<KVPair> Entries(const char *key = NULL,
+  typedef std::pair<String, V> KVPair; ///< The key is owned by the table
+
+  virtual V Get(const String &key) const = 0; ///< Returns NULL if not found
+  virtual bool Insert(const String &key, V value) = 0;
+  virtual V Update(const String &key, V value) = 0;
+  ///
+  /// Sets the value of key to desired only if it is still expected, which
+  /// must not be NULL. Returns whether it did.
+  ///
+  virtual bool Replace(const String &key, V expected, V desired) = 0;
+  virtual V Remove(const String &key) = 0;
+  ///
+  /// Returns up to n entries from key on, or from the start if key is
+  /// NULL. Unordered tables start at the key's position in their layout.
+  ///
+  virtual std::vector<KVPair> Entries(const String *key = NULL,
                                       std::size_t n = -1) const = 0;
   virtual std::size_t Size() const = 0;
 
@@ -0,0 +1,129 @@
+//
+//  striped_stl_hashtable.h
+//
+//  A hashtable split into independently locked STL shards.
+//
+
+#ifndef YCSB_C_LIB_STRIPED_STL_HASHTABLE_H_
+#define YCSB_C_LIB_STRIPED_STL_HASHTABLE_H_
+
+#include "lib/stl_hashtable.h"
+
+#include <shared_mutex>
+#include <vector>
+#include "lib/string.h"
+
+namespace vmp {
+
+template<class V, class MA = MemAlloc>
+class StripedStlHashtable : public StringHashtable<V> {
+ public:
+  typedef typename StringHashtable<V>::KVPair KVPair;
+
+  ///
+  /// @param num_shards Number of independently locked shards, rounded up to
+  ///        a power of two.
+  ///
+  StripedStlHashtable(std::size_t num_shards = 64);
+  ~StripedStlHashtable() { delete[] shards_; }
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL, size_t n = -1) const;
+  std::size_t Size() const;
+
+ private:
+  /// Each shard sits on its own cache lines so that locking one shard does
+  /// not invalidate its neighbours.
+  struct alignas(64) Shard {
+    StlHashtable<V, MA> table;
+    mutable std::shared_mutex mutex;
+  };
+
+  Shard &ShardOf(const String &key) const {
+    // Low bits pick the bucket inside a shard, so shard on the high bits.
+    return shards_[(key.hash() >> 32) & mask_];
+  }
+
+  Shard *shards_;
+  std::size_t mask_;
+};
+
+template<class V, class MA>
+StripedStlHashtable<V, MA>::StripedStlHashtable(std::size_t num_shards) {
+  std::size_t n = 1;
+  while (n < num_shards) n <<= 1;
+  shards_ = new Shard[n];
+  mask_ = n - 1;
+}
+
+template<class V, class MA>
+inline V StripedStlHashtable<V, MA>::Get(const String &key) const {
+  Shard &shard = ShardOf(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.table.Get(key);
+}
+
+template<class V, class MA>
+inline bool StripedStlHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value()) return false;
+  Shard &shard = ShardOf(key);
+  std::lock_guard<std::shared_mutex> lock(shard.mutex);
+  return shard.table.Insert(key, value);
+}
+
+template<class V, class MA>
+inline V StripedStlHashtable<V, MA>::Update(const String &key, V value) {
+  Shard &shard = ShardOf(key);
+  std::lock_guard<std::shared_mutex> lock(shard.mutex);
+  return shard.table.Update(key, value);
+}
+
+template<class V, class MA>
+inline bool StripedStlHashtable<V, MA>::Replace(const String &key,
+                                                V expected, V desired) {
+  Shard &shard = ShardOf(key);
+  std::lock_guard<std::shared_mutex> lock(shard.mutex);
+  return shard.table.Replace(key, expected, desired);
+}
+
+template<class V, class MA>
+inline V StripedStlHashtable<V, MA>::Remove(const String &key) {
+  Shard &shard = ShardOf(key);
+  std::lock_guard<std::shared_mutex> lock(shard.mutex);
+  return shard.table.Remove(key);
+}
+
+template<class V, class MA>
+std::size_t StripedStlHashtable<V, MA>::Size() const {
+  std::size_t size = 0;
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    size += shards_[i].table.Size();
+  }
+  return size;
+}
+
+template<class V, class MA>
+std::vector<typename StripedStlHashtable<V, MA>::KVPair>
+StripedStlHashtable<V, MA>::Entries(const String *key, size_t n) const {
+  std::vector<KVPair> pairs;
+  std::size_t i = key ? &ShardOf(*key) - shards_ : 0;
+  // Starts from the key in its own shard and continues with the following
+  // shards, locking one shard at a time.
+  for (; i <= mask_ && pairs.size() < n; ++i) {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    std::vector<KVPair> part = shards_[i].table.Entries(key, n - pairs.size());
+    if (key && part.empty()) break; // The key is not present
+    pairs.insert(pairs.end(), part.begin(), part.end());
+    key = NULL;
+  }
+  return pairs;
+}
+
+} // vmp
+
+#endif // YCSB_C_LIB_STRIPED_STL_HASHTABLE_H_
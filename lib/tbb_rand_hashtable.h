@@ -17,16 +17,20 @@
 
 namespace vmp {
 
-template<class V>
+template<class V, class MA = MemAlloc>
 class TbbRandHashtable : public StringHashtable<V> {
  public:
   typedef typename StringHashtable<V>::KVPair KVPair;
 
-  V Get(const char *key) const; ///< Returns NULL if the key is not found
-  bool Insert(const char *key, V value);
-  V Update(const char *key, V value);
-  V Remove(const char *key);
-  std::vector<KVPair> Entries(const char *key = NULL, std::size_t n = -1) const;
+  ~TbbRandHashtable();
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
+                              std::size_t n = -1) const;
   std::size_t Size() const { return table_.size(); }
 
  private:
@@ -41,56 +45,71 @@ class TbbRandHashtable : public StringHashtable<V> {
   mutable tbb::queuing_rw_mutex mutex_;
 };
 
-template<class V>
-V TbbRandHashtable<V>::Get(const char *key) const {
+template<class V, class MA>
+TbbRandHashtable<V, MA>::~TbbRandHashtable() {
+  for (const auto &pair : table_) String::Free<MA>(pair.first);
+}
+
+template<class V, class MA>
+V TbbRandHashtable<V, MA>::Get(const String &key) const {
   typename Hashtable::accessor result;
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
-  if (!table_.find(result, String::Wrap(key))) return NULL;
+  if (!table_.find(result, key)) return NULL;
   return result->second;
 }
 
-template<class V>
-bool TbbRandHashtable<V>::Insert(const char *key, V value) {
-  if (!key) return false;
-  String skey = String::Copy<MemAlloc>(key);
+template<class V, class MA>
+bool TbbRandHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value()) return false;
+  String skey = String::Copy<MA>(key);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
   return table_.insert(std::make_pair(skey, value));
 }
 
-template<class V>
-V TbbRandHashtable<V>::Update(const char *key, V value) {
+template<class V, class MA>
+V TbbRandHashtable<V, MA>::Update(const String &key, V value) {
   typename Hashtable::accessor result;
   V old(NULL);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
-  if (table_.find(result, String::Wrap(key))) {
+  if (table_.find(result, key)) {
     old = result->second;
     result->second = value;
   }
   return old;
 }
 
-template<class V>
-V TbbRandHashtable<V>::Remove(const char *key) {
+template<class V, class MA>
+bool TbbRandHashtable<V, MA>::Replace(const String &key, V expected,
+                                      V desired) {
+  typename Hashtable::accessor result;
+  tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
+  if (!table_.find(result, key) || result->second != expected) return false;
+  result->second = desired;
+  return true;
+}
+
+template<class V, class MA>
+V TbbRandHashtable<V, MA>::Remove(const String &key) {
   typename Hashtable::accessor result;
   V old(NULL);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
-  if (table_.find(result, String::Wrap(key))) {
-    String::Free<MemAlloc>(result->first);
+  if (table_.find(result, key)) {
+    String::Free<MA>(result->first);
     old = result->second;
     table_.erase(result);
   }
   return old;
 }
 
-template<class V>
-std::vector<typename TbbRandHashtable<V>::KVPair> TbbRandHashtable<V>::Entries(
-    const char *key, std::size_t n) const {
+template<class V, class MA>
+std::vector<typename TbbRandHashtable<V, MA>::KVPair>
+TbbRandHashtable<V, MA>::Entries(const String *key, std::size_t n) const {
   std::vector<KVPair> pairs;
   typename Hashtable::const_iterator pos;
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_);
-  pos = key ? table_.equal_range(String::Wrap(key)).first : table_.begin();
+  pos = key ? table_.equal_range(*key).first : table_.begin();
   for (std::size_t i = 0; pos != table_.end() && i < n; ++pos, ++i) {
-    pairs.push_back(std::make_pair(pos->first.value(), pos->second));
+    pairs.push_back(std::make_pair(pos->first, pos->second));
   }
   return pairs;
 }
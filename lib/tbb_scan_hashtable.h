@@ -17,17 +17,20 @@
 
 namespace vmp {
 
-template<class V>
+template<class V, class MA = MemAlloc>
 class TbbScanHashtable : public StringHashtable<V> {
  public:
   typedef typename StringHashtable<V>::KVPair KVPair;
   TbbScanHashtable() { table_.max_load_factor(2.0); }
-
-  V Get(const char *key) const; ///< Returns NULL if the key is not found
-  bool Insert(const char *key, V value);
-  V Update(const char *key, V value);
-  V Remove(const char *key);
-  std::vector<KVPair> Entries(const char *key = NULL, std::size_t n = -1) const;
+  ~TbbScanHashtable();
+
+  V Get(const String &key) const; ///< Returns NULL if the key is not found
+  bool Insert(const String &key, V value);
+  V Update(const String &key, V value);
+  bool Replace(const String &key, V expected, V desired);
+  V Remove(const String &key);
+  std::vector<KVPair> Entries(const String *key = NULL,
+                              std::size_t n = -1) const;
   std::size_t Size() const { return table_.size(); }
 
  private:
@@ -41,27 +44,32 @@ class TbbScanHashtable : public StringHashtable<V> {
   mutable tbb::queuing_rw_mutex mutex_;
 };
 
-template<class V>
-V TbbScanHashtable<V>::Get(const char *key) const {
+template<class V, class MA>
+TbbScanHashtable<V, MA>::~TbbScanHashtable() {
+  for (const auto &pair : table_) String::Free<MA>(pair.first);
+}
+
+template<class V, class MA>
+V TbbScanHashtable<V, MA>::Get(const String &key) const {
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
-  typename Hashtable::const_iterator it = table_.find(String::Wrap(key));
+  typename Hashtable::const_iterator it = table_.find(key);
   if (it == table_.end()) return NULL;
   return it->second;
 }
 
-template<class V>
-bool TbbScanHashtable<V>::Insert(const char *key, V value) {
-  if (!key) return false;
-  String skey = String::Copy<MemAlloc>(key);
+template<class V, class MA>
+bool TbbScanHashtable<V, MA>::Insert(const String &key, V value) {
+  if (!key.value()) return false;
+  String skey = String::Copy<MA>(key);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
   return table_.insert(std::make_pair(skey, value)).second;
 }
 
-template<class V>
-V TbbScanHashtable<V>::Update(const char *key, V value) {
+template<class V, class MA>
+V TbbScanHashtable<V, MA>::Update(const String &key, V value) {
   V old(NULL);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_);
-  typename Hashtable::iterator it = table_.find(String::Wrap(key));
+  typename Hashtable::iterator it = table_.find(key);
   if (it != table_.end()) {
     old = it->second;
     it->second = value;
@@ -69,28 +77,38 @@ V TbbScanHashtable<V>::Update(const char *key, V value) {
   return old;
 }
 
-template<class V>
-V TbbScanHashtable<V>::Remove(const char *key) {
+template<class V, class MA>
+bool TbbScanHashtable<V, MA>::Replace(const String &key, V expected,
+                                      V desired) {
+  tbb::queuing_rw_mutex::scoped_lock lock(mutex_);
+  typename Hashtable::iterator it = table_.find(key);
+  if (it == table_.end() || it->second != expected) return false;
+  it->second = desired;
+  return true;
+}
+
+template<class V, class MA>
+V TbbScanHashtable<V, MA>::Remove(const String &key) {
   V old(NULL);
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_);
-  typename Hashtable::iterator it = table_.find(String::Wrap(key));
+  typename Hashtable::iterator it = table_.find(key);
   if (it != table_.end()) {
-    String::Free<MemAlloc>(it->first);
+    String::Free<MA>(it->first);
     old = it->second;
     table_.unsafe_erase(it);
   }
   return old;
 }
 
-template<class V>
-std::vector<typename TbbScanHashtable<V>::KVPair> TbbScanHashtable<V>::Entries(
-    const char *key, std::size_t n) const {
+template<class V, class MA>
+std::vector<typename TbbScanHashtable<V, MA>::KVPair>
+TbbScanHashtable<V, MA>::Entries(const String *key, std::size_t n) const {
   std::vector<KVPair> pairs;
   typename Hashtable::const_iterator pos;
   tbb::queuing_rw_mutex::scoped_lock lock(mutex_, false);
-  pos = key ? table_.equal_range(String::Wrap(key)).first : table_.begin();
+  pos = key ? table_.equal_range(*key).first : table_.begin();
   for (std::size_t i = 0; pos != table_.end() && i < n; ++pos, ++i) {
-    pairs.push_back(std::make_pair(pos->first.value(), pos->second));
+    pairs.push_back(std::make_pair(pos->first, pos->second));
   }
   return pairs;
 }
@@ -0,0 +1,236 @@
+//
+// A C++ asynchronous Redis client that drives hiredis async contexts
+// from a single epoll loop owned by the calling thread
+//
+
+#ifndef YCSB_C_REDIS_ASYNC_CLIENT_H_
+#define YCSB_C_REDIS_ASYNC_CLIENT_H_
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "redis/hiredis/hiredis.h"
+#include "redis/hiredis/async.h"
+
+namespace ycsbc {
+
+class RedisAsyncClient {
+ public:
+  ///
+  /// Opens num_conns connections to host:port, each of which is allowed to
+  /// have at most inflight requests outstanding at any time.
+  /// If slaves is non-zero, every write is followed by a WAIT for that many
+  /// replicas, as RedisClient does.
+  ///
+  RedisAsyncClient(const char *host, int port, int slaves,
+                   int num_conns, int inflight);
+  ~RedisAsyncClient();
+
+  ///
+  /// Issues a command without waiting for its reply. Blocks in the event
+  /// loop only when the chosen connection already has a full window.
+  ///
+  void Command(int argc, const char **argv, const size_t *argvlen,
+               bool is_write);
+
+  ///
+  /// Runs the event loop until all outstanding replies have arrived.
+  ///
+  void Drain();
+
+  uint64_t errors() const { return errors_; }
+
+ private:
+  struct Connection {
+    RedisAsyncClient *client;
+    redisAsyncContext *context;
+    int fd;
+    uint32_t events; ///< Events currently registered with epoll
+    int inflight;
+  };
+
+  void Poll();
+  void Watch(Connection *conn, uint32_t events);
+
+  static void OnReply(redisAsyncContext *ac, void *reply, void *privdata);
+  static void OnConnect(const redisAsyncContext *ac, int status);
+  static void OnDisconnect(const redisAsyncContext *ac, int status);
+
+  static void AddRead(void *privdata);
+  static void DelRead(void *privdata);
+  static void AddWrite(void *privdata);
+  static void DelWrite(void *privdata);
+  static void Cleanup(void *privdata);
+
+  int epoll_fd_;
+  std::vector<Connection *> conns_;
+  std::vector<epoll_event> ready_;
+  size_t next_conn_;
+  int slaves_;
+  int inflight_limit_;
+  int outstanding_;
+  uint64_t errors_;
+};
+
+//
+// Implementation
+//
+inline RedisAsyncClient::RedisAsyncClient(const char *host, int port,
+    int slaves, int num_conns, int inflight) :
+    ready_(num_conns), next_conn_(0), slaves_(slaves),
+    inflight_limit_(inflight), outstanding_(0), errors_(0) {
+  assert(num_conns > 0 && inflight > 0);
+  epoll_fd_ = epoll_create1(0);
+  if (epoll_fd_ < 0) {
+    std::cerr << "Connect error: can't create epoll instance!" << std::endl;
+    exit(1);
+  }
+
+  for (int i = 0; i < num_conns; ++i) {
+    redisAsyncContext *ac = redisAsyncConnect(host, port);
+    if (!ac || ac->err) {
+      if (ac) {
+        std::cerr << "Connect error: " << ac->errstr << std::endl;
+        redisAsyncFree(ac);
+      } else {
+        std::cerr << "Connect error: can't allocate redis context!"
+                  << std::endl;
+      }
+      exit(1);
+    }
+
+    Connection *conn = new Connection{this, ac, ac->c.fd, 0, 0};
+    ac->data = conn;
+    ac->ev.data = conn;
+    ac->ev.addRead = AddRead;
+    ac->ev.delRead = DelRead;
+    ac->ev.addWrite = AddWrite;
+    ac->ev.delWrite = DelWrite;
+    ac->ev.cleanup = Cleanup;
+    redisAsyncSetConnectCallback(ac, OnConnect);
+    redisAsyncSetDisconnectCallback(ac, OnDisconnect);
+    conns_.push_back(conn);
+  }
+}
+
+inline RedisAsyncClient::~RedisAsyncClient() {
+  Drain();
+  for (Connection *conn : conns_) {
+    // Frees the context at once as nothing is pending, which in turn calls
+    // Cleanup() to deregister the socket.
+    redisAsyncDisconnect(conn->context);
+    delete conn;
+  }
+  close(epoll_fd_);
+}
+
+inline void RedisAsyncClient::Command(int argc, const char **argv,
+    const size_t *argvlen, bool is_write) {
+  Connection *conn = conns_[next_conn_];
+  next_conn_ = (next_conn_ + 1) % conns_.size();
+
+  const int cost = (is_write && slaves_) ? 2 : 1;
+  while (conn->inflight + cost > inflight_limit_ && conn->inflight > 0) {
+    Poll();
+  }
+
+  redisAsyncCommandArgv(conn->context, OnReply, conn, argc, argv, argvlen);
+  if (cost == 2) {
+    redisAsyncCommand(conn->context, OnReply, conn, "WAIT %d %d", slaves_, 0);
+  }
+  conn->inflight += cost;
+  outstanding_ += cost;
+}
+
+inline void RedisAsyncClient::Drain() {
+  while (outstanding_ > 0) {
+    Poll();
+  }
+}
+
+inline void RedisAsyncClient::Poll() {
+  int n = epoll_wait(epoll_fd_, ready_.data(), ready_.size(), -1);
+  for (int i = 0; i < n; ++i) {
+    Connection *conn = static_cast<Connection *>(ready_[i].data.ptr);
+    uint32_t events = ready_[i].events;
+    // Errors are fatal (see OnDisconnect), so the context stays valid
+    // between the two handlers.
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+      redisAsyncHandleRead(conn->context);
+    }
+    if (events & EPOLLOUT) {
+      redisAsyncHandleWrite(conn->context);
+    }
+  }
+}
+
+inline void RedisAsyncClient::Watch(Connection *conn, uint32_t events) {
+  if (events == conn->events) return;
+  epoll_event ev;
+  ev.events = events;
+  ev.data.ptr = conn;
+  int op = !conn->events ? EPOLL_CTL_ADD :
+      (!events ? EPOLL_CTL_DEL : EPOLL_CTL_MOD);
+  epoll_ctl(conn->client->epoll_fd_, op, conn->fd, &ev);
+  conn->events = events;
+}
+
+inline void RedisAsyncClient::OnReply(redisAsyncContext *ac, void *reply,
+    void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  redisReply *r = static_cast<redisReply *>(reply);
+  if (!r || r->type == REDIS_REPLY_ERROR) {
+    ++conn->client->errors_;
+  }
+  --conn->inflight;
+  --conn->client->outstanding_;
+}
+
+inline void RedisAsyncClient::OnConnect(const redisAsyncContext *ac,
+    int status) {
+  if (status != REDIS_OK) {
+    std::cerr << "Connect error: " << ac->errstr << std::endl;
+    exit(1);
+  }
+}
+
+inline void RedisAsyncClient::OnDisconnect(const redisAsyncContext *ac,
+    int status) {
+  if (status != REDIS_OK) {
+    std::cerr << "Connection lost: " << ac->errstr << std::endl;
+    exit(2);
+  }
+}
+
+inline void RedisAsyncClient::AddRead(void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  conn->client->Watch(conn, conn->events | EPOLLIN);
+}
+
+inline void RedisAsyncClient::DelRead(void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  conn->client->Watch(conn, conn->events & ~EPOLLIN);
+}
+
+inline void RedisAsyncClient::AddWrite(void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  conn->client->Watch(conn, conn->events | EPOLLOUT);
+}
+
+inline void RedisAsyncClient::DelWrite(void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  conn->client->Watch(conn, conn->events & ~EPOLLOUT);
+}
+
+inline void RedisAsyncClient::Cleanup(void *privdata) {
+  Connection *conn = static_cast<Connection *>(privdata);
+  conn->client->Watch(conn, 0);
+}
+
+} // namespace ycsbc
+
+#endif // YCSB_C_REDIS_ASYNC_CLIENT_H_
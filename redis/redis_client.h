@@ -17,10 +17,13 @@ class RedisClient {
   ~RedisClient();
 
   int Command(std::string cmd);
+  /// Binary-safe form of Command, taking each argument with its length.
+  int Command(int argc, const char **argv, const size_t *argvlen);
 
   redisContext *context() { return context_; }
  private:
   void HandleError(redisReply *reply, const char *hint);
+  void GetReplies(const char *hint);
 
   redisContext *context_;
   int slaves_;
@@ -50,13 +53,25 @@ inline RedisClient::~RedisClient() {
 }
 
 inline int RedisClient::Command(std::string cmd) {
-  redisReply *reply;
   redisAppendCommand(context_, cmd.data());
+  GetReplies(cmd.c_str());
+  return 0;
+}
+
+inline int RedisClient::Command(int argc, const char **argv,
+                                const size_t *argvlen) {
+  redisAppendCommandArgv(context_, argc, argv, argvlen);
+  GetReplies(argv[0]);
+  return 0;
+}
+
+inline void RedisClient::GetReplies(const char *hint) {
+  redisReply *reply;
   if (slaves_) {
     redisAppendCommand(context_, "WAIT %d %d", slaves_, 0);
   }
   if (redisGetReply(context_, (void **)&reply) == REDIS_ERR) {
-    HandleError(reply, cmd.c_str());
+    HandleError(reply, hint);
   }
   freeReplyObject(reply);
   if (slaves_) {
@@ -65,7 +80,6 @@ inline int RedisClient::Command(std::string cmd) {
     }
     freeReplyObject(reply);
   }
-  return 0;
 }
 
 inline void RedisClient::HandleError(redisReply *reply, const char *hint) {
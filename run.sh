@@ -3,8 +3,12 @@
 repeat_num=3
 db_names=(
   "lock_stl"
+  "striped_stl"
   "tbb_rand"
   "tbb_scan"
+  "lock_free"
+  "skiplist"
+  "art"
 )
 
 trap 'kill $(jobs -p)' SIGINT
@@ -15,16 +19,11 @@ if [ $# -ne 1 ]; then
 fi
 
 workload_dir=$1
+workloads=$(ls $workload_dir/workload*.spec | paste -sd, -)
 
-for file_name in $workload_dir/workload*.spec; do
-  for ((tn=1; tn<=8; tn=tn*2)); do
-    for db_name in ${db_names[@]}; do
-      for ((i=1; i<=repeat_num; ++i)); do
-        echo "Running $db_name with $tn threads for $file_name"
-        ./ycsbc -db $db_name -threads $tn -P $file_name 2>>ycsbc.output &
-        wait
-      done
-    done
-  done
-done
-
+# Loads each engine's data once for the workloads that leave it intact.
+./ycsbc -p sweep.dbs=$(IFS=,; echo "${db_names[*]}") \
+    -p sweep.threads=1,2,4,8 -p sweep.workloads=$workloads \
+    -p sweep.repeats=$repeat_num -p sweep.summary=ycsbc.summary.csv \
+    2>>ycsbc.output &
+wait
@@ -6,16 +6,33 @@
 //  Copyright (c) 2014 Jinglei Ren <jinglei@ren.systems>.
 //
 
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include <cstring>
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <future>
+#include <memory>
 #include "core/utils.h"
 #include "core/timer.h"
+#include "core/mem_stats.h"
+#include "core/perf_counters.h"
+#include "core/result_writer.h"
 #include "core/client.h"
+#include "core/coordinator.h"
 #include "core/core_workload.h"
+#include "core/histogram.h"
+#include "core/multi_table_workload.h"
+#include "core/trace_workload.h"
 #include "db/db_factory.h"
+#include "db/recording_db.h"
+#include "db/validating_db.h"
+#include "lib/epoch.h"
 
 using namespace std;
 
@@ -23,73 +40,681 @@ void UsageMessage(const char *command);
 bool StrStartWith(const char *str, const char *pre);
 string ParseCommandLine(int argc, const char *argv[], utils::Properties &props);
 
-int DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const int num_ops,
-    bool is_loading) {
+const double kMB = 1 << 20;
+
+///
+/// Prints process and engine memory after loading, in total and per record.
+///
+void PrintLoadMemory(const utils::MemStats &before, uint64_t engine_before,
+    uint64_t engine_after, int records) {
+  const utils::MemStats after = utils::SampleMemory();
+  const double rss = (double)after.rss - before.rss;
+  const double heap = (double)after.heap - before.heap;
+  const double engine = (double)engine_after - engine_before;
+  cerr << "# Memory after load (MB):\tRSS " << after.rss / kMB;
+  cerr << "\theap " << after.heap / kMB;
+  if (engine_after) cerr << "\tengine " << engine_after / kMB;
+  cerr << endl;
+  if (records <= 0) return;
+  cerr << "# Bytes per record:\tRSS " << rss / records;
+  cerr << "\theap " << heap / records;
+  if (engine_after) cerr << "\tengine " << engine / records;
+  cerr << endl;
+}
+
+///
+/// Picks the workload class named by the workload property, or the
+/// multi-table workload if tables are listed. Throws utils::Exception if
+/// tables are listed with a trace to record or replay.
+///
+ycsbc::CoreWorkload *CreateWorkload(const utils::Properties &props) {
+  const string name = props.GetProperty("workload");
+  const string trace = "TraceWorkload";
+  const bool replay = name.size() >= trace.size() &&
+      name.compare(name.size() - trace.size(), trace.size(), trace) == 0;
+  const bool tables =
+      !props.GetProperty(ycsbc::MultiTableWorkload::TABLES_PROPERTY).empty();
+  // Trace records keep no table, so they would all go to the default one.
+  if (tables && (replay || !props.GetProperty(
+      ycsbc::TraceWorkload::TRACE_RECORD_PROPERTY).empty() ||
+      !props.GetProperty(ycsbc::TraceWorkload::TRACE_FILE_PROPERTY).empty())) {
+    throw utils::Exception("Traces do not support tables");
+  }
+  if (replay) return new ycsbc::TraceWorkload;
+  if (tables) return new ycsbc::MultiTableWorkload;
+  return new ycsbc::CoreWorkload;
+}
+
+struct ClientResult {
+  int ops;
+  int oks;
+};
+
+///
+/// Issues num_ops operations, stopping early after seconds if positive.
+/// If ops_per_sec is positive, no operation is issued ahead of that rate.
+/// Times every operation into stats if given.
+///
+ClientResult DelegateClient(ycsbc::DB *db, ycsbc::CoreWorkload *wl,
+    const int num_ops, bool is_loading, double seconds, double ops_per_sec,
+    ycsbc::ClientStats *stats) {
+  typedef chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  const Clock::time_point deadline = start +
+      chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
   db->Init();
   ycsbc::Client client(*db, *wl);
-  int oks = 0;
+  ClientResult result = {0, 0};
+  // Counts the events of this thread from here on if asked to.
+  typedef utils::PerfCounters PerfCounters;
+  unique_ptr<PerfCounters> counters;
+  uint64_t begin[PerfCounters::kNumEvents], before[PerfCounters::kNumEvents];
+  if (stats && stats->count_events) {
+    counters.reset(new PerfCounters);
+    stats->events_available = counters->available();
+    counters->Read(begin);
+  }
   for (int i = 0; i < num_ops; ++i) {
-    if (is_loading) {
-      oks += client.DoInsert();
-    } else {
-      oks += client.DoTransaction();
+    if (ops_per_sec > 0) {
+      this_thread::sleep_until(start + chrono::duration_cast<Clock::duration>(
+          chrono::duration<double>(i / ops_per_sec)));
+    }
+    // Reads the clock only every 64 operations when running flat out.
+    if (seconds > 0 && (ops_per_sec > 0 || i % 64 == 0) &&
+        Clock::now() >= deadline) {
+      break;
+    }
+    const bool sampled = counters && stats->sample_events &&
+        i % stats->sample_events == 0;
+    if (sampled) counters->Read(before);
+    const Clock::time_point issued = stats ? Clock::now() : start;
+    const bool ok = is_loading ? client.DoInsert() : client.DoTransaction();
+    result.oks += ok;
+    ++result.ops;
+    if (stats) {
+      const ycsbc::Operation op = client.last_operation();
+      stats->latency[op].Add(chrono::duration_cast<chrono::nanoseconds>(
+          Clock::now() - issued).count());
+      if (sampled) {
+        uint64_t after[PerfCounters::kNumEvents];
+        counters->Read(after);
+        for (int e = 0; e < PerfCounters::kNumEvents; ++e) {
+          stats->sampled_events[op][e] += after[e] - before[e];
+        }
+        ++stats->samples[op];
+      }
+      if (!ok) {
+        stats->failed[op].store(stats->failed[op].load(memory_order_relaxed) +
+                                1, memory_order_relaxed);
+      }
+      stats->ops.store(result.ops, memory_order_relaxed);
+      stats->oks.store(result.oks, memory_order_relaxed);
+    }
+  }
+  if (counters) {
+    uint64_t end[PerfCounters::kNumEvents];
+    counters->Read(end);
+    for (int e = 0; e < PerfCounters::kNumEvents; ++e) {
+      stats->events[e] = end[e] - begin[e];
     }
   }
   db->Close();
-  return oks;
+  return result;
+}
+
+///
+/// Returns stats for each client thread if anything needs them, or else
+/// none, which leaves operations untimed.
+///
+vector<ycsbc::ClientStats *> NewClientStats(int num_threads, bool needed,
+    const ycsbc::ResultWriter &writer) {
+  vector<ycsbc::ClientStats *> stats;
+  if (!needed && !writer.enabled() && !writer.count_events()) return stats;
+  for (int i = 0; i < num_threads; ++i) {
+    stats.push_back(new ycsbc::ClientStats);
+    stats.back()->count_events = writer.count_events();
+    stats.back()->sample_events = writer.sample_events();
+  }
+  return stats;
+}
+
+///
+/// Loads the records of wl over num_threads threads, and returns how many
+/// were inserted.
+///
+int LoadRecords(ycsbc::DB *db, ycsbc::CoreWorkload *wl, int num_threads) {
+  vector<future<ClientResult>> actual_ops;
+  const int total_ops = wl->record_count();
+  for (int i = 0; i < num_threads; ++i) {
+    // Spreads the remainder so that every record gets loaded.
+    const int num_ops = total_ops / num_threads + (i < total_ops % num_threads);
+    actual_ops.emplace_back(async(launch::async,
+        DelegateClient, db, wl, num_ops, true, 0, 0, nullptr));
+  }
+  assert((int)actual_ops.size() == num_threads);
+
+  int sum = 0;
+  for (auto &n : actual_ops) {
+    assert(n.valid());
+    sum += n.get().oks;
+  }
+  return sum;
+}
+
+///
+/// Sends the coordinator the counts and latencies of a phase so far.
+///
+void SendSnapshot(ycsbc::CoordinatorLink *link, int phase, const string &name,
+    const vector<ycsbc::ClientStats *> &stats, double seconds, bool done) {
+  const ycsbc::ResultWriter::Sample total =
+      ycsbc::ResultWriter::Tally(stats, seconds);
+  utils::Histogram latency;
+  for (const ycsbc::ClientStats *s : stats) {
+    for (const utils::Histogram &op_latency : s->latency) {
+      latency.Merge(op_latency);
+    }
+  }
+  link->Snapshot(phase, name, total.ops, total.oks, seconds, latency, done);
+}
+
+///
+/// Returns the properties of each phase listed by the phases property: the
+/// base properties overlaid with those of the phase's file. Without phases,
+/// the run is a single phase of the base properties.
+///
+vector<utils::Properties> LoadPhases(const utils::Properties &props) {
+  vector<utils::Properties> phases;
+  stringstream files(props.GetProperty("phases"));
+  string file;
+  while (getline(files, file, ',')) {
+    file = utils::Trim(file);
+    if (file.empty()) continue;
+    utils::Properties phase = props;
+    phase.SetProperty("phase.name", file);
+    ifstream input(file);
+    if (!input.is_open()) throw utils::Exception("Cannot open phase " + file);
+    phase.Load(input);
+    phases.push_back(phase);
+  }
+  if (phases.empty()) phases.push_back(props);
+  return phases;
+}
+
+///
+/// Sets lock_free.capacity, unless given, to twice the keys the run may
+/// hold, as the table does not grow: the records wl loads plus an insert
+/// for every operation of every phase. Throws utils::Exception if a phase
+/// runs for a phase.duration, which sets no bound.
+///
+void SizeLockFree(utils::Properties &props, const ycsbc::CoreWorkload &wl,
+                  const vector<utils::Properties> &phases) {
+  if (props.GetProperty("dbname") != "lock_free" ||
+      !props.GetProperty("lock_free.capacity").empty()) {
+    return;
+  }
+  uint64_t keys = wl.record_count();
+  for (const utils::Properties &phase : phases) {
+    if (stod(phase.GetProperty("phase.duration", "0")) > 0) {
+      throw utils::Exception("lock_free needs lock_free.capacity when a "
+                             "phase runs for a phase.duration");
+    }
+    keys += stoull(phase.GetProperty(
+        ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY, "0"));
+  }
+  props.SetProperty("lock_free.capacity", to_string(keys * 2));
+}
+
+///
+/// Splits a comma-separated list, dropping blank items.
+///
+vector<string> SplitList(const string &list) {
+  vector<string> items;
+  stringstream input(list);
+  string item;
+  while (getline(input, item, ',')) {
+    item = utils::Trim(item);
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+///
+/// Returns the properties that decide what loading writes, so that sweep
+/// points with equal signatures can run on one loaded dataset. Sizes an
+/// engine derives from transaction properties, like lock_free.capacity,
+/// must be set beforehand to count.
+///
+string LoadSignature(const utils::Properties &p) {
+  typedef ycsbc::CoreWorkload W;
+  static const vector<string> transaction_only = {
+    "threadcount", "target", "phase.duration", W::OPERATION_COUNT_PROPERTY,
+    W::READ_PROPORTION_PROPERTY, W::UPDATE_PROPORTION_PROPERTY,
+    W::INSERT_PROPORTION_PROPERTY, W::SCAN_PROPORTION_PROPERTY,
+    W::READMODIFYWRITE_PROPORTION_PROPERTY, W::DELETE_PROPORTION_PROPERTY,
+    W::READ_ALL_FIELDS_PROPERTY, W::WRITE_ALL_FIELDS_PROPERTY,
+    W::FIELD_WEIGHTS_PROPERTY, W::READ_TARGET_PROPERTY,
+    W::REQUEST_DISTRIBUTION_PROPERTY, W::ZIPFIAN_CONSTANT_PROPERTY,
+    W::HOTSPOT_ROTATION_SHIFT_PROPERTY, W::HOTSPOT_ROTATION_OPS_PROPERTY,
+    W::HOTSPOT_ROTATION_SECONDS_PROPERTY, W::HOTSPOT_DATA_FRACTION_PROPERTY,
+    W::HOTSPOT_OPN_FRACTION_PROPERTY, W::EXPONENTIAL_PERCENTILE_PROPERTY,
+    W::EXPONENTIAL_FRAC_PROPERTY, W::MAX_SCAN_LENGTH_PROPERTY,
+    W::SCAN_LENGTH_DISTRIBUTION_PROPERTY
+  };
+  string signature;
+  for (const auto &prop : p.properties()) {
+    if (find(transaction_only.begin(), transaction_only.end(), prop.first) !=
+        transaction_only.end()) {
+      continue;
+    }
+    if (StrStartWith(prop.first.c_str(), "sweep.") ||
+        StrStartWith(prop.first.c_str(), "output.")) {
+      continue;
+    }
+    signature.append(prop.first).append("=").append(prop.second).append("\n");
+  }
+  return signature;
+}
+
+///
+/// Returns whether the transactions of p change which records exist, after
+/// which a loaded dataset cannot be reused.
+///
+bool ChangesRecords(const utils::Properties &p) {
+  typedef ycsbc::CoreWorkload W;
+  return stod(p.GetProperty(W::INSERT_PROPORTION_PROPERTY,
+                            W::INSERT_PROPORTION_DEFAULT)) > 0 ||
+      stod(p.GetProperty(W::DELETE_PROPORTION_PROPERTY,
+                         W::DELETE_PROPORTION_DEFAULT)) > 0 ||
+      utils::StrToBool(p.GetProperty(W::CHURN_PROPERTY, W::CHURN_DEFAULT)) ||
+      !p.GetProperty(ycsbc::TraceWorkload::TRACE_FILE_PROPERTY).empty();
+}
+
+///
+/// Returns the two-sided 95% quantile of Student's t distribution.
+///
+double StudentT95(int degrees) {
+  static const double quantiles[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  const int n = sizeof(quantiles) / sizeof(quantiles[0]);
+  return degrees <= n ? quantiles[degrees - 1] : 1.96;
+}
+
+///
+/// The throughput of every repeat of one engine, workload and thread count.
+///
+struct SweepPoint {
+  string db;
+  string workload;
+  int threads;
+  vector<double> ktps;
+};
+
+///
+/// Prints the median, mean and 95% confidence interval of the mean of each
+/// point, and writes them as CSV to file if it is not empty.
+///
+void PrintSweep(const vector<SweepPoint> &points, const string &file) {
+  ofstream csv;
+  if (!file.empty()) {
+    csv.open(file);
+    if (!csv) throw utils::Exception("Cannot write " + file);
+    csv << "db,workload,threads,repeats,median_ktps,mean_ktps,ci95_low,"
+           "ci95_high,min_ktps,max_ktps" << endl;
+  }
+  cerr << "# Sweep summary (KTPS)" << endl;
+  cerr << "# db\tworkload\tthreads\trepeats\tmedian\tmean\tci95" << endl;
+  for (const SweepPoint &point : points) {
+    vector<double> sorted = point.ktps;
+    sort(sorted.begin(), sorted.end());
+    const size_t n = sorted.size();
+    const double median = n % 2 ? sorted[n / 2] :
+        (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    double mean = 0;
+    for (const double x : sorted) mean += x;
+    mean /= n;
+    double variance = 0;
+    for (const double x : sorted) variance += (x - mean) * (x - mean);
+    const double half = n > 1 ?
+        StudentT95(n - 1) * sqrt(variance / (n - 1) / n) : 0;
+    cerr << "# " << point.db << '\t' << point.workload << '\t';
+    cerr << point.threads << '\t' << n << '\t' << median << '\t' << mean;
+    cerr << "\t[" << mean - half << ", " << mean + half << "]" << endl;
+    if (csv.is_open()) {
+      csv << point.db << ',' << point.workload << ',' << point.threads << ','
+          << n << ',' << median << ',' << mean << ',' << mean - half << ','
+          << mean + half << ',' << sorted.front() << ',' << sorted.back()
+          << endl;
+    }
+  }
+}
+
+///
+/// Runs every combination of the engines in sweep.dbs, the thread counts in
+/// sweep.threads and the workload files in sweep.workloads, sweep.repeats
+/// times each, in one process. A point reuses the data loaded for the one
+/// before if their loads match and the one before neither inserted nor
+/// deleted records; workloads that do are run last for each engine.
+///
+int RunSweep(const utils::Properties &props, const string &file_name) {
+  for (const string &unsupported : {string("phases"),
+       ycsbc::Coordinator::ADDRESS_PROPERTY,
+       ycsbc::TraceWorkload::TRACE_RECORD_PROPERTY,
+       ycsbc::ResultWriter::JSON_PROPERTY}) {
+    if (!props.GetProperty(unsupported).empty()) {
+      throw utils::Exception("A sweep does not support " + unsupported);
+    }
+  }
+  if (utils::StrToBool(props.GetProperty(
+      ycsbc::ValidatingDB::VALIDATE_PROPERTY,
+      ycsbc::ValidatingDB::VALIDATE_DEFAULT))) {
+    throw utils::Exception("A sweep does not support validate");
+  }
+
+  const vector<string> dbs = SplitList(props.GetProperty("sweep.dbs",
+      props.GetProperty("dbname")));
+  vector<int> thread_counts;
+  for (const string &n : SplitList(props.GetProperty("sweep.threads",
+      props.GetProperty("threadcount", "1")))) {
+    thread_counts.push_back(stoi(n));
+    if (thread_counts.back() <= 0) {
+      throw utils::Exception("Bad thread count in sweep.threads: " + n);
+    }
+  }
+  const int repeats = stoi(props.GetProperty("sweep.repeats", "1"));
+  if (dbs.empty() || thread_counts.empty() || repeats <= 0) {
+    throw utils::Exception("A sweep needs engines, thread counts and repeats");
+  }
+
+  // Overlays each workload file on the base properties.
+  vector<pair<string, utils::Properties>> workloads;
+  for (const string &file : SplitList(props.GetProperty("sweep.workloads"))) {
+    utils::Properties p = props;
+    ifstream input(file);
+    if (!input.is_open()) throw utils::Exception("Cannot open " + file);
+    p.Load(input);
+    workloads.emplace_back(file, p);
+  }
+  if (workloads.empty()) workloads.emplace_back(file_name, props);
+  stable_partition(workloads.begin(), workloads.end(),
+      [](const pair<string, utils::Properties> &w) {
+        return !ChangesRecords(w.second);
+      });
+
+  vector<SweepPoint> points;
+  ycsbc::DB *db = NULL;
+  string loaded;
+  bool changed = false;
+  for (const string &db_name : dbs) {
+    for (const auto &workload : workloads) {
+      for (const int num_threads : thread_counts) {
+        SweepPoint point = {db_name, workload.first, num_threads, {}};
+        for (int r = 0; r < repeats; ++r) {
+          utils::Properties p = workload.second;
+          p.SetProperty("dbname", db_name);
+          p.SetProperty("threadcount", to_string(num_threads));
+          ycsbc::CoreWorkload *wl = CreateWorkload(p);
+          wl->Init(p);
+
+          // The capacity of lock_free follows from the transactions too,
+          // so sizing first keeps it in the signature.
+          SizeLockFree(p, *wl, {p});
+          const string signature = LoadSignature(p);
+          if (!db || changed || signature != loaded) {
+            if (db) {
+              db->Close();
+              delete db;
+              // Frees the records it retired, which may need to go back to
+              // the slabs before the next point configures them.
+              vmp::Epoch::Drain();
+            }
+            db = ycsbc::DBFactory::CreateDB(p);
+            if (!db) throw utils::Exception("Unknown database name " + db_name);
+            db->Init();
+            utils::Timer<double> timer;
+            timer.Start();
+            const int records = LoadRecords(db, wl, num_threads);
+            cerr << "# Loading records:\t" << records << "\t";
+            cerr << timer.End() << " s" << endl;
+            loaded = signature;
+          }
+          changed = ChangesRecords(p);
+
+          ycsbc::ResultWriter writer(p, workload.first);
+          vector<ycsbc::ClientStats *> stats =
+              NewClientStats(num_threads, false, writer);
+          const double seconds = stod(p.GetProperty("phase.duration", "0"));
+          const double target = stod(p.GetProperty("target", "0"));
+          const int total_ops = seconds > 0 ? INT_MAX :
+              stoi(p[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+          vector<future<ClientResult>> actual_ops;
+          utils::Timer<double> timer;
+          timer.Start();
+          for (int i = 0; i < num_threads; ++i) {
+            actual_ops.emplace_back(async(launch::async,
+                DelegateClient, db, wl, total_ops / num_threads, false,
+                seconds, target / num_threads,
+                stats.empty() ? nullptr : stats[i]));
+          }
+          int ops = 0;
+          for (auto &n : actual_ops) ops += n.get().ops;
+          const double duration = timer.End();
+          delete wl;
+
+          if (!stats.empty()) {
+            ycsbc::ResultWriter::PrintEvents(cerr, stats);
+            writer.AddPhase("run", duration, stats, {});
+            writer.Write();
+            for (ycsbc::ClientStats *s : stats) delete s;
+          }
+          point.ktps.push_back(ops / duration / 1000);
+          // Keeps the lines of run.sh, which parse_result.py reads.
+          cerr << db_name << '\t' << workload.first << '\t' << num_threads;
+          cerr << '\t' << point.ktps.back() << endl;
+        }
+        points.push_back(point);
+      }
+    }
+  }
+  if (db) {
+    db->Close();
+    delete db;
+  }
+  PrintSweep(points, props.GetProperty("sweep.summary"));
+  return 0;
 }
 
 int main(const int argc, const char *argv[]) {
   utils::Properties props;
   string file_name = ParseCommandLine(argc, argv, props);
 
+  // Drives worker processes instead of running a workload if asked to.
+  if (stoi(props.GetProperty(ycsbc::Coordinator::WORKERS_PROPERTY, "0")) > 0) {
+    ycsbc::Coordinator coordinator(props, file_name);
+    return coordinator.Run(argc, argv);
+  }
+
+  // Runs a matrix of engines, thread counts and workloads if asked to.
+  if (!props.GetProperty("sweep.dbs").empty() ||
+      !props.GetProperty("sweep.threads").empty() ||
+      !props.GetProperty("sweep.workloads").empty()) {
+    return RunSweep(props, file_name);
+  }
+
+  const int num_threads = stoi(props.GetProperty("threadcount", "1"));
+
+  // Joins a coordinator, which assigns this worker its share of the keys.
+  ycsbc::CoordinatorLink *link = NULL;
+  const string address = props.GetProperty(
+      ycsbc::Coordinator::ADDRESS_PROPERTY);
+  if (!address.empty()) {
+    link = new ycsbc::CoordinatorLink(address, num_threads);
+    props.SetProperty(ycsbc::CoreWorkload::KEY_PARTITION_INDEX_PROPERTY,
+                      to_string(link->index()));
+    props.SetProperty(ycsbc::CoreWorkload::KEY_PARTITION_COUNT_PROPERTY,
+                      to_string(link->count()));
+    // Keeps the results of workers apart when they share a directory.
+    for (const string &output : {ycsbc::ResultWriter::JSON_PROPERTY,
+                                 ycsbc::ResultWriter::CSV_PROPERTY}) {
+      const string file = props.GetProperty(output);
+      if (file.empty()) continue;
+      props.SetProperty(output, file + "." + to_string(link->index()));
+    }
+  }
+  ycsbc::CoreWorkload *wl = CreateWorkload(props);
+  wl->Init(props);
+  const vector<utils::Properties> phases = LoadPhases(props);
+  SizeLockFree(props, *wl, phases);
+  ycsbc::ResultWriter writer(props, file_name);
+
   ycsbc::DB *db = ycsbc::DBFactory::CreateDB(props);
   if (!db) {
     cout << "Unknown database name " << props["dbname"] << endl;
     exit(0);
   }
 
-  ycsbc::CoreWorkload wl;
-  wl.Init(props);
+  // Checks reads against the writes of the whole run if asked to.
+  ycsbc::ValidatingDB *validator = NULL;
+  if (utils::StrToBool(props.GetProperty(
+      ycsbc::ValidatingDB::VALIDATE_PROPERTY,
+      ycsbc::ValidatingDB::VALIDATE_DEFAULT))) {
+    if (link) {
+      throw utils::Exception("validate does not support coordinated workers");
+    }
+    if (props["dbname"] == "redis_async") {
+      // Reads return before their replies, with no fields to check.
+      throw utils::Exception("validate does not support redis_async");
+    }
+    const uint64_t max_keys = wl->record_count() + stoull(props.GetProperty(
+        ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY, "0"));
+    validator = new ycsbc::ValidatingDB(*db, stod(props.GetProperty(
+        ycsbc::ValidatingDB::VALIDATE_SAMPLE_PROPERTY,
+        ycsbc::ValidatingDB::VALIDATE_SAMPLE_DEFAULT)), max_keys);
+    db = validator;
+  }
 
-  const int num_threads = stoi(props.GetProperty("threadcount", "1"));
+  // Keeps a session of its own so that the DB stays open for sampling.
+  db->Init();
+  const utils::MemStats mem_before = utils::SampleMemory();
+  const uint64_t engine_before = db->MemoryUsage();
 
   // Loads data
-  vector<future<int>> actual_ops;
-  int total_ops = stoi(props[ycsbc::CoreWorkload::RECORD_COUNT_PROPERTY]);
-  for (int i = 0; i < num_threads; ++i) {
-    actual_ops.emplace_back(async(launch::async,
-        DelegateClient, db, &wl, total_ops / num_threads, true));
-  }
-  assert((int)actual_ops.size() == num_threads);
-
-  int sum = 0;
-  for (auto &n : actual_ops) {
-    assert(n.valid());
-    sum += n.get();
-  }
+  if (link) link->Barrier();
+  utils::Timer<double> load_timer;
+  load_timer.Start();
+  const int sum = LoadRecords(db, wl, num_threads);
+  const double load_duration = load_timer.End();
+  if (link) link->Loaded(sum, load_duration);
+  writer.Loaded(sum, load_duration);
   cerr << "# Loading records:\t" << sum << endl;
+  PrintLoadMemory(mem_before, engine_before, db->MemoryUsage(), sum);
 
-  // Peforms transactions
-  actual_ops.clear();
-  total_ops = stoi(props[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
-  utils::Timer<double> timer;
-  timer.Start();
-  for (int i = 0; i < num_threads; ++i) {
-    actual_ops.emplace_back(async(launch::async,
-        DelegateClient, db, &wl, total_ops / num_threads, false));
-  }
-  assert((int)actual_ops.size() == num_threads);
+  // Records the transactions of any workload if asked to.
+  ycsbc::DB *run_db = db;
+  const string record_file = props.GetProperty(
+      ycsbc::TraceWorkload::TRACE_RECORD_PROPERTY);
+  if (!record_file.empty()) run_db = new ycsbc::RecordingDB(*db, record_file);
 
-  sum = 0;
-  for (auto &n : actual_ops) {
-    assert(n.valid());
-    sum += n.get();
+  // Peforms transactions, phase after phase on the same data
+  const bool scheduled = !props.GetProperty("phases").empty();
+  int run_ops = 0;
+  double run_duration = 0;
+  for (size_t p = 0; p < phases.size(); ++p) {
+    utils::Properties phase = phases[p];
+    if (scheduled) {
+      // Continues from the keys that earlier phases inserted.
+      wl->CarryOver(phase);
+      delete wl;
+      wl = CreateWorkload(phase);
+      wl->Init(phase);
+    }
+    const double seconds = stod(phase.GetProperty("phase.duration", "0"));
+    double target = stod(phase.GetProperty("target", "0"));
+    int total_ops = seconds > 0 ? INT_MAX :
+        stoi(phase[ycsbc::CoreWorkload::OPERATION_COUNT_PROPERTY]);
+
+    // Times every operation for the coordinator or the result files.
+    vector<ycsbc::ClientStats *> stats =
+        NewClientStats(num_threads, link != NULL, writer);
+    if (link) {
+      // Runs this worker's share.
+      if (seconds <= 0) {
+        total_ops = total_ops / link->count() +
+            (link->index() < total_ops % link->count());
+      }
+      target /= link->count();
+      link->Barrier();
+    }
+
+    vector<future<ClientResult>> actual_ops;
+    utils::Timer<double> timer;
+    timer.Start();
+    for (int i = 0; i < num_threads; ++i) {
+      actual_ops.emplace_back(async(launch::async,
+          DelegateClient, run_db, wl, total_ops / num_threads, false,
+          seconds, target / num_threads, stats.empty() ? nullptr : stats[i]));
+    }
+    assert((int)actual_ops.size() == num_threads);
+
+    const string phase_name = phase.GetProperty("phase.name", "run");
+    promise<void> phase_done;
+    vector<ycsbc::ResultWriter::Sample> series;
+    thread reporter;
+    if (!stats.empty()) {
+      // Workers sample at the pace of their snapshots.
+      const double interval = link ? stod(props.GetProperty(
+          ycsbc::Coordinator::INTERVAL_PROPERTY,
+          ycsbc::Coordinator::INTERVAL_DEFAULT)) : writer.interval();
+      reporter = thread([&, interval] {
+        future<void> done = phase_done.get_future();
+        while (done.wait_for(chrono::duration<double>(interval)) ==
+               future_status::timeout) {
+          const double elapsed = timer.End();
+          series.push_back(ycsbc::ResultWriter::Tally(stats, elapsed));
+          if (link) SendSnapshot(link, p, phase_name, stats, elapsed, false);
+        }
+      });
+    }
+
+    ClientResult phase_sum = {0, 0};
+    for (auto &n : actual_ops) {
+      assert(n.valid());
+      const ClientResult result = n.get();
+      phase_sum.ops += result.ops;
+      phase_sum.oks += result.oks;
+    }
+    const double duration = timer.End();
+    if (!stats.empty()) {
+      phase_done.set_value();
+      reporter.join();
+      if (link) SendSnapshot(link, p, phase_name, stats, duration, true);
+      ycsbc::ResultWriter::PrintEvents(cerr, stats);
+      writer.AddPhase(phase_name, duration, stats, series);
+      for (ycsbc::ClientStats *s : stats) delete s;
+    }
+    run_ops += phase_sum.ops;
+    run_duration += duration;
+    if (scheduled) {
+      cerr << "# Phase " << p + 1 << " (" << phase["phase.name"] << "):\t";
+      cerr << phase_sum.ops << " ops\t" << phase_sum.ops - phase_sum.oks;
+      cerr << " failed\t" << duration << " s\t";
+      cerr << phase_sum.ops / duration / 1000 << " KTPS" << endl;
+    }
   }
-  double duration = timer.End();
+  if (run_db != db) delete run_db; // Completes the trace
+  cerr << "# Peak RSS (MB):\t" << utils::SampleMemory().peak_rss / kMB << endl;
+  db->Close();
   cerr << "# Transaction throughput (KTPS)" << endl;
   cerr << props["dbname"] << '\t' << file_name << '\t' << num_threads << '\t';
-  cerr << total_ops / duration / 1000 << endl;
+  cerr << run_ops / run_duration / 1000 << endl;
+  writer.Write();
+  delete link; // Tells the coordinator this worker is done
+  if (validator) {
+    validator->Report(cerr);
+    if (validator->errors()) return 1;
+  }
 }
 
 string ParseCommandLine(int argc, const char *argv[], utils::Properties &props) {